@@ -6,38 +6,188 @@
 #ifndef STRING_H_INCLUDED
 #define STRING_H_INCLUDED
 #include <stdio.h>
+#include <stddef.h>
 
+#define STRING_INLINE_CAPACITY 24 /* bytes stored inside the string object itself--including the terminating null character */
+#define STRING_DEFAULT_GROWTH_FACTOR 1.5 /* factor by which a full char array grows--see string_set_growth_factor() */
+#define STRING_ARENA_DEFAULT_BLOCK_SIZE 65536 /* bytes per block allocated by a string arena */
+#define STRING_BUILDER_DEFAULT_CHUNK_SIZE 4096 /* bytes per chunk allocated by a string builder */
+
+#define STRING_FLAG_IMMUTABLE 0x1 /* the contents of the string object may not be changed */
+#define STRING_FLAG_INTERNED 0x2 /* the string object belongs to the intern table--see string_intern() */
+#define STRING_FLAG_SHARED 0x4 /* char_array points into a shared buffer--see string_set_copy_on_write() */
+#define STRING_FLAG_HASHED 0x8 /* hash holds the string object's hash--see string_hash() */
+
+#define STRING_CLASS_ALPHA 0 /* A-Z and a-z--see string_charset_class() */
+#define STRING_CLASS_DIGIT 1 /* 0-9 */
+#define STRING_CLASS_ALPHANUM 2 /* A-Z, a-z and 0-9 */
+#define STRING_CLASS_XDIGIT 3 /* 0-9, A-F and a-f */
+#define STRING_CLASS_UPPER 4 /* A-Z */
+#define STRING_CLASS_LOWER 5 /* a-z */
+#define STRING_CLASS_SPACE 6 /* space, \t, \n, \v, \f and \r */
+#define STRING_CLASS_PUNCT 7 /* printable characters other than letters, digits and space */
+#define STRING_CLASS_CNTRL 8 /* 0-31 and 127 */
+#define STRING_CLASS_PRINT 9 /* 32-126 */
+#define STRING_CLASS_COUNT 10
+
+#define STRING_NUM_OK 0 /* the conversion succeeded--see string_to_int64() */
+#define STRING_NUM_INVALID 1 /* the string is NULL or not a number of the expected form */
+#define STRING_NUM_OVERFLOW 2 /* the number does not fit the result type */
+
+typedef struct string_shared_buffer_t string_shared_buffer_t; /* reference counted char array */
+
+typedef struct string_arena_t string_arena_t; /* region allocator for string objects--see string_arena_init() */
+
+typedef struct string_builder_t string_builder_t; /* appends pieces without moving earlier ones--see string_builder_init() */
+
+typedef struct string_pattern_t string_pattern_t; /* needle compiled for repeated searches--see string_pattern_compile() */
+
+typedef struct string_multimatch_t string_multimatch_t; /* searches for many needles at once--see string_multimatch_init() */
+
+typedef int (*string_multimatch_fn)(int needle_id, int offset, void* context);
+
+typedef struct string_rope_t string_rope_t; /* balanced tree of chunks for very large strings--see string_rope_init() */
+
+typedef struct string_map_t string_map_t; /* hash map from strings to fixed-size values--see string_map_cust_init() */
+
+typedef void* (*string_malloc_fn)(size_t size, void* context);
+typedef void* (*string_realloc_fn)(void* block, size_t size, void* context);
+typedef void (*string_free_fn)(void* block, void* context);
+
+typedef struct string_alloc_stats_t
+{
+    unsigned long long allocations; /* number of successful allocations */
+    unsigned long long reallocations; /* number of successful reallocations */
+    unsigned long long frees; /* number of blocks freed */
+    unsigned long long bytes_requested; /* total bytes asked for by allocations and reallocations */
+    unsigned long long bytes_live; /* bytes currently allocated */
+    unsigned long long peak_bytes_live; /* highest value bytes_live has reached */
+} string_alloc_stats_t;
+
+/* One entry of a substitution table--see string_replace_many(). */
+typedef struct string_replacement_t
+{
+    const char* from; /* text to replace */
+    const char* to; /* text to put in its place */
+} string_replacement_t;
+
+/* A set of byte values. Byte c is in the set if bit (c >> 4) & 7 of bits[(c & 0x0f) + (c & 0x80 ? 16 : 0)] is set,
+   a layout that lets the class functions look up many bytes at once. Build sets with string_charset_clear() and
+   string_charset_add() or start from string_charset_class(); sets need no cleanup. */
+typedef struct string_charset_t
+{
+    unsigned char bits[32];
+} string_charset_t;
+
+/* Short strings live in inline_buffer and spill to a heap allocated array once they outgrow it. Because char_array
+   may point into the object itself, string objects must never be copied by value--use string_copy_sptr() instead.
+   inline_buffer is allocated along with the object, so string objects are only ever created by the initializers. */
 typedef struct string_t
 {
-    char* char_array;
+    char* char_array; /* points to inline_buffer or to a heap allocated char array */
     int length; /* number of chars in the array--excluding the terminating null character */
     int capacity; /* number of bytes currently allocated for the associated char array */
+    string_arena_t* arena; /* arena the string object's memory comes from or NULL if it lives on the heap */
+    int inline_capacity; /* size of inline_buffer--larger than STRING_INLINE_CAPACITY for string_flat_init() objects */
+    unsigned int flags; /* combination of the STRING_FLAG_* values */
+    unsigned long long hash; /* cached string_hash() value, valid while STRING_FLAG_HASHED is set */
+    string_shared_buffer_t* shared_buffer; /* buffer char_array points into when STRING_FLAG_SHARED is set */
+    char inline_buffer[]; /* small-string storage of inline_capacity bytes, used until the contents outgrow it */
 } string_t;
 
+/* A non-owning view of a run of characters; it is not null-terminated and stays valid only as long as the
+   characters it refers to. A view whose chars pointer is NULL stands for a NULL string. */
+typedef struct string_view_t
+{
+    const char* chars;
+    int length;
+} string_view_t;
+
 string_t* string_init(void); /* allocates memory for and returns a pointer to a string object of default size */
 
 string_t* string_cust_init(int initial_size);
 
+string_t* string_flat_init(int initial_size); /* header and chars in one allocation--grow it with the *_h functions */
+
 void string_destroy(string_t* str);
 
+void string_set_allocator(string_malloc_fn malloc_fn, string_realloc_fn realloc_fn, string_free_fn free_fn,
+                          void* context);
+
+void string_get_alloc_stats(string_alloc_stats_t* stats);
+
+void string_reset_alloc_stats(void);
+
+string_arena_t* string_arena_init(int block_size);
+
+void string_arena_reset(string_arena_t* arena);
+
+void string_arena_destroy(string_arena_t* arena);
+
+string_t* string_init_in(string_arena_t* arena);
+
+string_t* string_cust_init_in(string_arena_t* arena, int initial_size);
+
+void string_set_growth_factor(double factor);
+
+void string_set_copy_on_write(int enabled);
+
+int string_reserve(string_t* str, int num_chars);
+
+int string_reserve_h(string_t** str, int num_chars);
+
+void string_shrink_to_fit(string_t* str);
+
 void string_print(string_t* str, int add_new_line);
 
 #define string_puts(str) (string_print(str, 1))
 
 int string_equal(const string_t* str1, const string_t* str2);
 
+int string_compare(const string_t* str1, const string_t* str2);
+
+int string_compare_cstr(const string_t* str1, const char* str2);
+
 void string_copy_sptr(string_t* dest, const string_t* source);
 
+void string_copy_sptr_h(string_t** dest, const string_t* source);
+
 void string_copy_cptr_sptr(string_t* dest, const char* source);
 
+void string_copy_cptr_sptr_h(string_t** dest, const char* source);
+
 void string_concat(string_t* str1, const string_t* str2);
 
+void string_concat_h(string_t** str1, const string_t* str2);
+
 void string_tolower(string_t* str);
 
 void string_toupper(string_t* str);
 
+int string_tolower_copy(string_t* dest, const string_t* source);
+
+int string_toupper_copy(string_t* dest, const string_t* source);
+
+int string_equal_ci(const string_t* str1, const string_t* str2);
+
+int string_compare_ci(const string_t* str1, const string_t* str2);
+
+void string_set_hash_seed(unsigned long long seed);
+
+unsigned long long string_hash(const string_t* str);
+
+unsigned long long string_hash_ci(const string_t* str);
+
 void string_remove_nonalpha(string_t* str);
 
+int string_filter(string_t* str, const string_charset_t* set, int bool_keep);
+
+int string_trim(string_t* str, const string_charset_t* set);
+
+int string_ltrim(string_t* str, const string_charset_t* set);
+
+int string_rtrim(string_t* str, const string_charset_t* set);
+
 int string_isalpha(const string_t* str);
 
 int string_isalphanum(const string_t* str);
@@ -46,12 +196,24 @@ int string_isnonalpha(const string_t* str);
 
 int string_toint(const string_t* str);
 
+int string_to_int64(const string_t* str, long long* out, int base);
+
+int string_to_uint64(const string_t* str, unsigned long long* out, int base);
+
+int string_to_double(const string_t* str, double* out);
+
+int string_append_double(string_t* str, double value);
+
+int string_append_double_h(string_t** str, double value);
+
 int string_equal_cstring(const string_t* str1, const char* str2);
 
 int string_is_int(const string_t* str);
 
 void string_fgets(string_t* dest_str, int len, FILE* strm);
 
+void string_fgets_h(string_t** dest_str, int len, FILE* strm);
+
 #define string_fputs(str, strm) (fputs(str->char_array, strm))
 
 string_t* string_scan_s(void);
@@ -62,6 +224,8 @@ string_t* string_get_slice(const string_t* source, int beg_slice_indx, int end_s
 
 void string_copy_range(string_t* dest, const string_t* source, int src_strt_idx, int num_to_copy);
 
+void string_copy_range_h(string_t** dest, const string_t* source, int src_strt_idx, int num_to_copy);
+
 int string_in(string_t* str_to_search, char* str_to_find);
 
 int string_in2(string_t* str_to_search, string_t* str_to_find);
@@ -74,8 +238,225 @@ void string_set_range(string_t* dest, char* replacement_str, int start_pos, int
 
 void string_set_range2(string_t* dest, string_t* replacement_str, int start_pos, int end_pos);
 
+int string_splice(string_t* dest, int pos, int remove_len, const char* insert_ptr, int insert_len);
+
+int string_splice_h(string_t** dest, int pos, int remove_len, const char* insert_ptr, int insert_len);
+
+int string_insert(string_t* dest, int pos, const char* str_to_insert);
+
+int string_insert_h(string_t** dest, int pos, const char* str_to_insert);
+
+int string_erase(string_t* dest, int pos, int num_to_erase);
+
 int string_replace(string_t* dest, char* str_to_replace, char* replacement_text);
 
 int string_replace2(string_t* dest, string_t* str_to_replace, string_t* replacement_text);
 
+int string_replace_h(string_t** dest, char* str_to_replace, char* replacement_text);
+
+int string_replace_all(string_t* dest, const char* str_to_replace, const char* replacement_text);
+
+int string_replace_all_h(string_t** dest, const char* str_to_replace, const char* replacement_text);
+
+int string_replace_many(string_t* dest, const string_replacement_t* table, int num_replacements);
+
+string_view_t string_view_from_string(const string_t* str);
+
+string_view_t string_view_from_cstr(const char* cstr);
+
+string_view_t string_slice_view(const string_t* source, int beg_slice_indx, int end_slice_indx);
+
+string_view_t string_view_slice(string_view_t source, int beg_slice_indx, int end_slice_indx);
+
+string_t* string_view_to_string(string_view_t view);
+
+int string_view_equal(string_view_t view1, string_view_t view2);
+
+int string_view_equal_cstring(string_view_t view, const char* cstr);
+
+int string_view_compare(string_view_t view1, string_view_t view2);
+
+int string_view_equal_ci(string_view_t view1, string_view_t view2);
+
+int string_view_compare_ci(string_view_t view1, string_view_t view2);
+
+unsigned long long string_view_hash(string_view_t view);
+
+unsigned long long string_view_hash_seeded(string_view_t view, unsigned long long seed);
+
+unsigned long long string_view_hash_ci(string_view_t view);
+
+int string_view_find(string_view_t haystack, string_view_t needle, int search_strt_pos);
+
+int string_view_find_cstr(string_view_t haystack, const char* str_to_find, int search_strt_pos);
+
+int string_view_in(string_view_t haystack, const char* str_to_find);
+
+int string_view_is_int(string_view_t view);
+
+int string_view_toint(string_view_t view);
+
+int string_view_to_int64(string_view_t view, long long* out, int base);
+
+int string_view_to_uint64(string_view_t view, unsigned long long* out, int base);
+
+int string_view_to_double(string_view_t view, double* out);
+
+int string_view_isalpha(string_view_t view);
+
+int string_view_isalphanum(string_view_t view);
+
+int string_view_isnonalpha(string_view_t view);
+
+void string_charset_clear(string_charset_t* set);
+
+void string_charset_add(string_charset_t* set, unsigned char character);
+
+void string_charset_add_range(string_charset_t* set, unsigned char first, unsigned char last);
+
+void string_charset_add_chars(string_charset_t* set, const char* chars);
+
+void string_charset_invert(string_charset_t* set);
+
+int string_charset_from_spec(string_charset_t* set, const char* spec);
+
+int string_charset_contains(const string_charset_t* set, unsigned char character);
+
+const string_charset_t* string_charset_class(int char_class);
+
+int string_view_all_in(string_view_t view, const string_charset_t* set, int* first_offender);
+
+int string_all_in(const string_t* str, const string_charset_t* set, int* first_offender);
+
+int string_span(const string_t* str, const string_charset_t* set, int start_pos);
+
+int string_cspan(const string_t* str, const string_charset_t* set, int start_pos);
+
+int string_find_first_of(const string_t* str, const string_charset_t* set, int search_strt_pos);
+
+int string_find_last_of(const string_t* str, const string_charset_t* set, int search_end_pos);
+
+string_pattern_t* string_pattern_compile(const char* str_to_find);
+
+void string_pattern_destroy(string_pattern_t* pattern);
+
+int string_pattern_find(const string_pattern_t* pattern, const string_t* haystack, int search_strt_pos);
+
+int string_pattern_find_view(const string_pattern_t* pattern, string_view_t haystack, int search_strt_pos);
+
+int string_pattern_count(const string_pattern_t* pattern, const string_t* haystack);
+
+string_multimatch_t* string_multimatch_init(const char** needles, int num_needles);
+
+void string_multimatch_destroy(string_multimatch_t* matcher);
+
+int string_multimatch_find(const string_multimatch_t* matcher, const string_t* haystack, int* needle_id);
+
+int string_multimatch_find_all(const string_multimatch_t* matcher, const string_t* haystack,
+                               string_multimatch_fn callback, void* context);
+
+int string_multimatch_any(const string_multimatch_t* matcher, const string_t* haystack);
+
+string_builder_t* string_builder_init(void);
+
+string_builder_t* string_builder_cust_init(int chunk_size);
+
+void string_builder_reset(string_builder_t* builder);
+
+void string_builder_destroy(string_builder_t* builder);
+
+int string_builder_length(const string_builder_t* builder);
+
+int string_builder_append_cstr(string_builder_t* builder, const char* cstr);
+
+int string_builder_append_string(string_builder_t* builder, const string_t* str);
+
+int string_builder_append_view(string_builder_t* builder, string_view_t view);
+
+int string_builder_append_char(string_builder_t* builder, char character);
+
+int string_builder_append_int(string_builder_t* builder, long long value);
+
+string_t* string_builder_to_string(const string_builder_t* builder);
+
+int string_builder_write(const string_builder_t* builder, FILE* strm);
+
+int string_builder_write_fd(const string_builder_t* builder, int fd);
+
+string_rope_t* string_rope_init(void);
+
+string_rope_t* string_rope_from_cstr(const char* cstr);
+
+string_rope_t* string_rope_from_string(const string_t* str);
+
+void string_rope_destroy(string_rope_t* rope);
+
+int string_rope_length(const string_rope_t* rope);
+
+int string_rope_char_at(const string_rope_t* rope, int index);
+
+string_t* string_rope_to_string(const string_rope_t* rope);
+
+string_rope_t* string_rope_get_slice(const string_rope_t* source, int beg_slice_indx, int end_slice_indx);
+
+int string_rope_insert_cstr(string_rope_t* rope, int pos, const char* cstr);
+
+int string_rope_insert(string_rope_t* rope, int pos, const string_rope_t* insertion);
+
+int string_rope_concat_cstr(string_rope_t* rope, const char* cstr);
+
+int string_rope_concat(string_rope_t* rope1, const string_rope_t* rope2);
+
+int string_rope_erase(string_rope_t* rope, int pos, int num_to_erase);
+
+int string_rope_find_cstr(const string_rope_t* rope, const char* str_to_find, int search_strt_pos);
+
+int string_rope_find(const string_rope_t* rope, const string_t* str_to_find, int search_strt_pos);
+
+int string_rope_replace(string_rope_t* rope, const char* str_to_replace, const char* replacement_text);
+
+string_map_t* string_map_init(void);
+
+string_map_t* string_map_cust_init(int value_size);
+
+void string_map_clear(string_map_t* map);
+
+void string_map_destroy(string_map_t* map);
+
+int string_map_size(const string_map_t* map);
+
+int string_map_reserve(string_map_t* map, int num_entries);
+
+void* string_map_find(const string_map_t* map, const string_t* key);
+
+void* string_map_find_cstr(const string_map_t* map, const char* key);
+
+void* string_map_find_view(const string_map_t* map, string_view_t key);
+
+void* string_map_insert(string_map_t* map, const string_t* key, int* bool_inserted);
+
+void* string_map_insert_cstr(string_map_t* map, const char* key, int* bool_inserted);
+
+void* string_map_insert_view(string_map_t* map, string_view_t key, int* bool_inserted);
+
+int string_map_erase(string_map_t* map, const string_t* key);
+
+int string_map_erase_cstr(string_map_t* map, const char* key);
+
+int string_map_erase_view(string_map_t* map, string_view_t key);
+
+int string_map_put(string_map_t* map, const char* key, void* value);
+
+void* string_map_get(const string_map_t* map, const char* key);
+
+int string_map_next(const string_map_t* map, int* iter, string_view_t* key, void** value);
+
+string_t* string_intern(const string_t* str);
+
+string_t* string_intern_cstr(const char* cstr);
+
+int string_interned_equal(const string_t* str1, const string_t* str2);
+
+void string_intern_cleanup(void);
+
 #endif /* STRING_H_INCLUDED */
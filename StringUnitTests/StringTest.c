@@ -2,13 +2,35 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
 #include "StringTest.h"
 #include "String.h"
 
 /* string data type tests */
 
+/* a tracking allocator for test_string_set_allocator; its context counts the calls made to it. */
+static void* test_malloc(size_t size, void* context)
+{
+    ((int*)context)[0]++;
+    return malloc(size);
+}
+
+static void* test_realloc(void* block, size_t size, void* context)
+{
+    ((int*)context)[1]++;
+    return realloc(block, size);
+}
+
+static void test_free(void* block, void* context)
+{
+    ((int*)context)[2]++;
+    free(block);
+}
+
 void start_testing(void)
 {
+    test_string_set_allocator(); /* first: the allocator may only be changed while no string objects exist */
     test_string_equal();
     test_string_copy_cptr_sptr();
     test_string_copy_sptr();
@@ -28,6 +50,30 @@ void start_testing(void)
     test_string_in();
     test_string_set_range();
     test_string_replace();
+    test_string_inline_storage();
+    test_string_reserve();
+    test_string_shrink_to_fit();
+    test_string_arena();
+    test_string_flat_init();
+    test_string_intern();
+    test_string_set_copy_on_write();
+    test_string_view();
+    test_string_rope();
+    test_string_builder();
+    test_string_pattern();
+    test_string_multimatch();
+    test_string_replace_all();
+    test_string_replace_many();
+    test_string_splice();
+    test_string_case();
+    test_string_charset();
+    test_string_filter();
+    test_string_charset_span();
+    test_string_hash();
+    test_string_map();
+    test_string_compare();
+    test_string_to_int64();
+    test_string_double();
 }
 
 void test_string_equal(void)
@@ -154,6 +200,10 @@ void test_string_copy_cptr_sptr(void) /* whitebox testing is absolutely necessar
     test_str6 = string_cust_init(1);
     string_copy_cptr_sptr(test_str6, "abcdefghijjiklmnopqrstuvwxyz");
     assert(string_equal_cstring(test_str6, "abcdefghijjiklmnopqrstuvwxyz"));
+
+    /* the C string may be the string object's own characters */
+    string_copy_cptr_sptr(test_str6, test_str6->char_array + 3);
+    assert(string_equal_cstring(test_str6, "defghijjiklmnopqrstuvwxyz") && test_str6->length == 25);
     string_destroy(test_str6);
 }
 
@@ -689,3 +739,1527 @@ void test_string_replace(void)
     assert(string_equal_cstring(test_str, "A is a string expression for function testing."));
 }
 
+void test_string_inline_storage(void)
+{
+    string_t* test_str      =       string_init();
+    string_t* test_str2     =       string_cust_init(100);
+    string_t* test_str3     =       string_init();
+
+    /* short strings should be stored inside the string object itself. */
+    string_copy_cptr_sptr(test_str, "short key");
+    assert(test_str->char_array == test_str->inline_buffer);
+    assert(string_equal_cstring(test_str, "short key"));
+
+    /* a string that fills the inline buffer exactly should still fit. */
+    string_copy_cptr_sptr(test_str3, "exactly twenty three ch");
+    assert(test_str3->char_array == test_str3->inline_buffer);
+    assert(string_equal_cstring(test_str3, "exactly twenty three ch"));
+
+    /* growing past the inline buffer should move the contents to the heap transparently. */
+    string_concat(test_str, test_str3);
+    assert(test_str->char_array != test_str->inline_buffer);
+    assert(string_equal_cstring(test_str, "short keyexactly twenty three ch"));
+
+    /* large custom capacities are allocated on the heap from the start. */
+    assert(test_str2->char_array != test_str2->inline_buffer && test_str2->capacity == 100);
+    string_copy_range(test_str3, test_str, 0, 5);
+    assert(string_equal_cstring(test_str3, "short"));
+
+    string_destroy(test_str);
+    string_destroy(test_str2);
+    string_destroy(test_str3);
+}
+
+void test_string_reserve(void)
+{
+    string_t* test_str      =       string_init();
+    string_t* test_piece    =       string_init();
+    char* reserved_array    =       NULL;
+    int num_regrowths       =       0;
+    int old_capacity, i, bool_reserved;
+
+    bool_reserved = string_reserve(NULL, 10);
+    assert(!bool_reserved);
+    bool_reserved = string_reserve(test_str, -1);
+    assert(!bool_reserved);
+
+    string_copy_cptr_sptr(test_str, "keep me");
+    bool_reserved = string_reserve(test_str, 1000);
+    assert(bool_reserved);
+    assert(test_str->capacity >= 1001);
+    assert(string_equal_cstring(test_str, "keep me")); /* reserving must not change the contents. */
+
+    /* appending within the reserved capacity must not move the char array. */
+    reserved_array = test_str->char_array;
+    string_copy_cptr_sptr(test_piece, "abc");
+    for (i = 0; i < 300; i++)
+        string_concat(test_str, test_piece);
+    assert(test_str->char_array == reserved_array);
+    assert(test_str->length == 7 + 300 * 3);
+
+    /* appending past the capacity should grow geometrically, not by a fixed amount. */
+    string_destroy(test_str);
+    test_str = string_init();
+    old_capacity = test_str->capacity;
+    for (i = 0; i < 100000; i++)
+    {
+        string_concat(test_str, test_piece);
+        if (test_str->capacity != old_capacity)
+        {
+            num_regrowths++;
+            old_capacity = test_str->capacity;
+        }
+    }
+    assert(test_str->length == 300000);
+    assert(num_regrowths < 40);
+
+    string_destroy(test_str);
+    string_destroy(test_piece);
+}
+
+void test_string_shrink_to_fit(void)
+{
+    string_t* test_str      =       string_cust_init(500);
+
+    string_shrink_to_fit(NULL); /* This should not crash. */
+
+    string_copy_cptr_sptr(test_str, "This string is longer than the inline buffer.");
+    string_shrink_to_fit(test_str);
+    assert(test_str->capacity == test_str->length + 1);
+    assert(string_equal_cstring(test_str, "This string is longer than the inline buffer."));
+
+    /* a string short enough for the inline buffer should move back into it. */
+    string_copy_range(test_str, test_str, 0, 4);
+    string_shrink_to_fit(test_str);
+    assert(test_str->char_array == test_str->inline_buffer);
+    assert(string_equal_cstring(test_str, "This"));
+
+    string_destroy(test_str);
+}
+
+void test_string_arena(void)
+{
+    string_arena_t* test_arena  =       string_arena_init(256);
+    string_t* test_str1         =       NULL;
+    string_t* test_str2         =       NULL;
+    string_t* test_str3         =       NULL;
+    string_t* first_str         =       NULL;
+    int i;
+
+    assert(test_arena != NULL);
+    test_str1 = string_init_in(NULL);
+    assert(test_str1 == NULL);
+    test_str1 = string_cust_init_in(test_arena, 0);
+    assert(test_str1 == NULL);
+
+    test_str1 = string_init_in(test_arena);
+    test_str2 = string_cust_init_in(test_arena, 100);
+    first_str = test_str1;
+
+    string_copy_cptr_sptr(test_str1, "arena ");
+    string_copy_cptr_sptr(test_str2, "strings");
+    assert(test_str1->arena == test_arena && test_str2->capacity == 100);
+
+    /* growth inside an arena should keep the contents intact, even across several arena blocks. */
+    for (i = 0; i < 200; i++)
+        string_concat(test_str1, test_str2);
+    assert(test_str1->length == 6 + 200 * 7);
+    test_str3 = string_get_slice(test_str1, 0, 13);
+    assert(string_equal_cstring(test_str3, "arena strings"));
+    string_destroy(test_str3); /* a heap string */
+
+    string_destroy(test_str1); /* destroying an arena string should leave it to the arena. */
+
+    /* after a reset the arena's memory is handed out again from the start. */
+    string_arena_reset(test_arena);
+    test_str1 = string_init_in(test_arena);
+    assert(test_str1 == first_str);
+    string_copy_cptr_sptr(test_str1, "reused");
+    assert(string_equal_cstring(test_str1, "reused"));
+
+    string_arena_reset(NULL); /* This should not crash. */
+    string_arena_destroy(test_arena);
+    string_arena_destroy(NULL);
+}
+
+void test_string_flat_init(void)
+{
+    string_t* test_str      =       string_flat_init(40);
+    string_t* test_str2     =       string_init();
+    string_t* test_piece    =       string_init();
+    string_t* test_empty    =       string_flat_init(0);
+    int i, bool_changed;
+
+    assert(test_empty == NULL);
+
+    /* the characters of a flat string object live right after its fields. */
+    assert(test_str->char_array == test_str->inline_buffer && test_str->capacity == 40);
+    string_copy_cptr_sptr_h(&test_str, "A flat string of more than 24 chars.");
+    assert(test_str->char_array == test_str->inline_buffer);
+    assert(string_equal_cstring(test_str, "A flat string of more than 24 chars."));
+
+    /* growing through the handle should keep the string object in a single allocation. */
+    string_copy_cptr_sptr(test_piece, "0123456789");
+    for (i = 0; i < 100; i++)
+        string_concat_h(&test_str, test_piece);
+    assert(test_str->char_array == test_str->inline_buffer);
+    assert(test_str->length == 36 + 100 * 10);
+
+    string_concat_h(&test_str, test_str); /* concatenating a string object onto itself. */
+    assert(test_str->length == 2 * (36 + 100 * 10));
+    assert(test_str->char_array[test_str->length] == '\0');
+
+    bool_changed = string_reserve_h(&test_str, 5000);
+    assert(bool_changed);
+    assert(test_str->capacity == 5001 && test_str->char_array == test_str->inline_buffer);
+
+    /* a regular string object grown through a handle becomes a single allocation as well. */
+    string_copy_range_h(&test_str2, test_str, 0, 40);
+    assert(test_str2->char_array == test_str2->inline_buffer);
+    assert(string_equal_cstring(test_str2, "A flat string of more than 24 chars.0123"));
+
+    bool_changed = string_replace_h(&test_str2, "flat", "single allocation");
+    assert(bool_changed);
+    assert(string_equal_cstring(test_str2, "A single allocation string of more than 24 chars.0123"));
+
+    /* the regular functions still work on a flat string object by moving its characters out. */
+    string_copy_sptr(test_str2, test_str);
+    assert(string_equal(test_str2, test_str));
+
+    string_destroy(test_str);
+    string_destroy(test_str2);
+    string_destroy(test_piece);
+}
+
+void test_string_set_allocator(void)
+{
+    int call_counts[3]              =       {0, 0, 0}; /* malloc, realloc, free */
+    string_alloc_stats_t stats;
+    string_t* test_str              =       NULL;
+    string_t* test_str2             =       NULL;
+    string_arena_t* test_arena      =       NULL;
+
+    string_set_allocator(test_malloc, test_realloc, test_free, call_counts);
+    string_get_alloc_stats(&stats);
+    assert(stats.allocations == 0 && stats.reallocations == 0 && stats.frees == 0 && stats.bytes_live == 0);
+
+    /* a short string costs exactly one allocation. */
+    test_str = string_init();
+    string_copy_cptr_sptr(test_str, "short");
+    assert(call_counts[0] == 1);
+
+    /* growing past the inline buffer allocates a char array, and growing it again reallocates it. */
+    string_copy_cptr_sptr(test_str, "This is long enough to leave the inline buffer.");
+    string_copy_cptr_sptr(test_str2 = string_init(), " And a little more to force a reallocation.");
+    string_concat(test_str, test_str2);
+    string_get_alloc_stats(&stats);
+    assert(stats.allocations == 4 && call_counts[0] == 4);
+    assert(stats.reallocations == 1 && call_counts[1] == 1);
+    assert(stats.bytes_live == stats.peak_bytes_live && stats.bytes_live > 0);
+
+    test_arena = string_arena_init(0);
+    string_copy_cptr_sptr(string_init_in(test_arena), "arena strings come from one block");
+    string_arena_destroy(test_arena);
+
+    string_destroy(test_str);
+    string_destroy(test_str2);
+    string_get_alloc_stats(&stats);
+    assert(stats.bytes_live == 0 && stats.peak_bytes_live > 0);
+    assert(stats.frees == 6 && call_counts[2] == 6);
+
+    string_reset_alloc_stats();
+    string_get_alloc_stats(&stats);
+    assert(stats.allocations == 0 && stats.bytes_requested == 0 && stats.peak_bytes_live == 0);
+
+    string_set_allocator(NULL, NULL, NULL, NULL); /* restore the standard allocator. */
+    test_str = string_init();
+    string_destroy(test_str);
+    assert(call_counts[0] == 6);
+}
+
+void test_string_intern(void)
+{
+    string_t* test_str      =       string_init();
+    string_t* interned1     =       NULL;
+    string_t* interned2     =       NULL;
+    string_t* interned3     =       NULL;
+    string_t* interned4     =       NULL;
+    char key[16];
+    int i, bool_reserved;
+
+    interned4 = string_intern(NULL);
+    assert(interned4 == NULL);
+    interned4 = string_intern_cstr(NULL);
+    assert(interned4 == NULL);
+
+    string_copy_cptr_sptr(test_str, "Content-Type");
+    interned1 = string_intern(test_str);
+    interned2 = string_intern_cstr("Content-Type");
+    interned3 = string_intern_cstr("Content-Length");
+
+    /* equal contents give the very same object. */
+    assert(interned1 != NULL && interned1 != test_str);
+    assert(string_interned_equal(interned1, interned2));
+    assert(!string_interned_equal(interned1, interned3));
+    assert(string_equal_cstring(interned1, "Content-Type"));
+    interned4 = string_intern(interned1);
+    assert(interned4 == interned1);
+
+    /* interned strings are immutable and owned by the table. */
+    string_tolower(interned1);
+    string_copy_cptr_sptr(interned1, "something else");
+    string_concat(interned1, test_str);
+    bool_reserved = string_reserve(interned1, 100);
+    assert(!bool_reserved);
+    assert(string_equal_cstring(interned1, "Content-Type"));
+    string_destroy(interned1);
+    interned4 = string_intern_cstr("Content-Type");
+    assert(interned4 == interned2);
+
+    /* the table should keep every string reachable as it grows. */
+    for (i = 0; i < 1000; i++)
+    {
+        sprintf(key, "key%d", i);
+        interned4 = string_intern_cstr(key);
+        assert(string_equal_cstring(interned4, key));
+    }
+    interned3 = string_intern_cstr("key500");
+    interned4 = string_intern_cstr("key500");
+    assert(interned3 == interned4);
+    interned4 = string_intern_cstr("");
+    assert(interned4 != NULL && interned4->length == 0);
+
+    string_intern_cleanup();
+    string_destroy(test_str);
+}
+
+void test_string_set_copy_on_write(void)
+{
+    string_t* test_source   =       string_init();
+    string_t* test_copy1    =       string_init();
+    string_t* test_copy2    =       string_init();
+    string_t* test_slice    =       NULL;
+    string_t* test_slice2   =       NULL;
+    string_alloc_stats_t stats_before, stats_after;
+
+    string_set_copy_on_write(1);
+    string_copy_cptr_sptr(test_source, "A payload that is much too long for the inline buffer.");
+
+    /* copies share the source's char array... */
+    string_copy_sptr(test_copy1, test_source);
+    string_get_alloc_stats(&stats_before);
+    string_copy_sptr(test_copy2, test_source);
+    string_get_alloc_stats(&stats_after);
+    assert(stats_after.allocations == stats_before.allocations); /* sharing an already shared array is free. */
+    assert(test_copy1->char_array == test_source->char_array && test_copy2->char_array == test_source->char_array);
+    assert(string_equal(test_copy1, test_source) && string_equal(test_copy2, test_source));
+
+    /* ...until one side changes. */
+    string_toupper(test_copy1);
+    assert(test_copy1->char_array != test_source->char_array);
+    assert(string_equal_cstring(test_copy1, "A PAYLOAD THAT IS MUCH TOO LONG FOR THE INLINE BUFFER."));
+    assert(string_equal_cstring(test_source, "A payload that is much too long for the inline buffer."));
+    assert(string_equal(test_copy2, test_source));
+
+    string_concat(test_source, test_copy1);
+    assert(string_equal_cstring(test_copy2, "A payload that is much too long for the inline buffer."));
+
+    /* slices running to the end of the source share its characters; other slices are copied. */
+    test_slice = string_get_slice(test_copy2, 10, -1);
+    assert(test_slice->char_array == test_copy2->char_array + 10);
+    assert(string_equal_cstring(test_slice, "that is much too long for the inline buffer."));
+    test_slice2 = string_get_slice(test_copy2, 2, 9);
+    assert(string_equal_cstring(test_slice2, "payload"));
+
+    string_set_range(test_slice, "THAT", 0, 3);
+    assert(string_equal_cstring(test_slice, "THAT is much too long for the inline buffer."));
+    assert(string_equal_cstring(test_copy2, "A payload that is much too long for the inline buffer."));
+
+    /* destroying any of the sharing string objects leaves the others intact. */
+    string_copy_sptr(test_copy1, test_copy2);
+    string_destroy(test_copy2);
+    assert(string_equal_cstring(test_copy1, "A payload that is much too long for the inline buffer."));
+    string_replace(test_copy1, "payload", "load");
+    assert(string_equal_cstring(test_copy1, "A load that is much too long for the inline buffer."));
+
+    string_set_copy_on_write(0);
+    string_copy_sptr(test_copy1, test_source);
+    assert(test_copy1->char_array != test_source->char_array && string_equal(test_copy1, test_source));
+
+    string_destroy(test_source);
+    string_destroy(test_copy1);
+    string_destroy(test_slice);
+    string_destroy(test_slice2);
+}
+
+void test_string_view(void)
+{
+    string_t* test_line         =       string_init();
+    string_t* test_copy         =       NULL;
+    string_view_t test_method, test_path, test_version, test_null_view;
+    string_alloc_stats_t stats_before, stats_after;
+    int first_space, second_space;
+
+    string_copy_cptr_sptr(test_line, "GET /index.html?page=42 HTTP/1.1");
+    test_null_view = string_view_from_string(NULL);
+    assert(test_null_view.chars == NULL);
+
+    /* splitting a request line into views should not allocate anything. */
+    string_get_alloc_stats(&stats_before);
+    first_space     =   string_find_cstr(test_line, " ", 0);
+    second_space    =   string_find_cstr(test_line, " ", first_space + 1);
+    test_method     =   string_slice_view(test_line, 0, first_space);
+    test_path       =   string_slice_view(test_line, first_space + 1, second_space);
+    test_version    =   string_slice_view(test_line, second_space + 1, -1);
+    string_get_alloc_stats(&stats_after);
+    assert(stats_after.allocations == stats_before.allocations);
+
+    assert(string_view_equal_cstring(test_method, "GET"));
+    assert(string_view_equal_cstring(test_path, "/index.html?page=42"));
+    assert(string_view_equal_cstring(test_version, "HTTP/1.1"));
+    assert(string_view_isalpha(test_method) && !string_view_isalpha(test_path));
+    assert(string_view_in(test_path, "page") && !string_view_in(test_path, "HTTP"));
+    assert(string_view_find_cstr(test_path, "=", 0) == 16);
+    assert(string_view_toint(string_view_slice(test_path, 17, -1)) == 42);
+    assert(string_view_is_int(string_view_from_cstr("-42")) && !string_view_is_int(string_view_from_cstr("-")));
+    assert(string_view_toint(string_view_from_cstr("-42")) == -42);
+    assert(string_view_isalphanum(string_view_slice(test_version, 0, 4)));
+    assert(string_view_isnonalpha(string_view_slice(test_version, 5, -1)));
+
+    /* invalid slices give NULL views, just like string_get_slice gives NULL string objects. */
+    assert(string_slice_view(test_line, 10, 5).chars == NULL);
+    assert(string_slice_view(NULL, 0, 1).chars == NULL);
+    assert(string_view_equal(test_null_view, string_slice_view(test_line, 100, -1)));
+    assert(!string_view_equal(test_null_view, test_method));
+    assert(string_view_equal(test_method, string_view_from_cstr("GET")));
+
+    /* partial matches must not hide a later match, nor count as one at the end of the haystack. */
+    assert(string_view_find_cstr(string_view_from_cstr("aaab"), "aab", 0) == 1);
+    assert(string_view_find_cstr(string_view_from_cstr("xab"), "abc", 0) == -1);
+
+    test_copy = string_view_to_string(test_path);
+    assert(string_equal_cstring(test_copy, "/index.html?page=42"));
+    string_destroy(test_copy);
+    test_copy = string_view_to_string(test_null_view);
+    assert(test_copy == NULL);
+
+    string_destroy(test_line);
+}
+
+void test_string_rope(void)
+{
+    string_rope_t* test_rope        =       string_rope_from_cstr("The quick fox");
+    string_rope_t* test_slice       =       NULL;
+    string_rope_t* test_bad_slice   =       NULL;
+    string_t* test_str              =       NULL;
+    string_t* test_find_str         =       string_init();
+    string_alloc_stats_t stats_before, stats_after;
+    unsigned int test_seed          =       1;
+    int i, bool_changed, bool_changed2;
+
+    assert(test_rope != NULL && string_rope_length(test_rope) == 13);
+    bool_changed    =   string_rope_insert_cstr(test_rope, 10, "brown ");
+    bool_changed2   =   string_rope_concat_cstr(test_rope, " jumps");
+    assert(bool_changed && bool_changed2);
+    assert(string_rope_char_at(test_rope, 10) == 'b' && string_rope_char_at(test_rope, 100) == -1);
+
+    /* slices share the text but are changed independently of the source. */
+    test_slice      =   string_rope_get_slice(test_rope, 4, 9);
+    bool_changed    =   string_rope_erase(test_rope, 4, 6);
+    assert(bool_changed);
+    test_str = string_rope_to_string(test_rope);
+    assert(string_equal_cstring(test_str, "The brown fox jumps"));
+    string_destroy(test_str);
+    test_str = string_rope_to_string(test_slice);
+    assert(string_equal_cstring(test_str, "quick"));
+    string_destroy(test_str);
+
+    bool_changed    =   string_rope_insert(test_rope, 4, test_slice);
+    bool_changed2   =   string_rope_insert_cstr(test_rope, 9, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_rope_erase(test_rope, 20, 10);
+    bool_changed2   =   string_rope_insert_cstr(test_rope, 100, "x");
+    assert(!bool_changed && !bool_changed2);
+    test_bad_slice = string_rope_get_slice(test_rope, 5, 2);
+    assert(test_bad_slice == NULL);
+
+    /* searches cross chunk boundaries and behave like string_find_cstr(). */
+    string_copy_cptr_sptr(test_find_str, "ck br");
+    assert(string_rope_find(test_rope, test_find_str, 0) == 7);
+    assert(string_rope_find_cstr(test_rope, "fox", 0) == 16 && string_rope_find_cstr(test_rope, "fox", 17) == -1);
+    assert(string_rope_find_cstr(test_rope, "", 0) == -1 && string_rope_find_cstr(test_rope, NULL, 0) == -1);
+
+    /* repeated, identical calls replace successive occurrences, just like string_replace(). */
+    bool_changed    =   string_rope_replace(test_rope, "o", "0");
+    bool_changed2   =   string_rope_replace(test_rope, "o", "0");
+    assert(bool_changed && bool_changed2);
+    test_str = string_rope_to_string(test_rope);
+    assert(string_equal_cstring(test_str, "The quick br0wn f0x jumps"));
+    string_destroy(test_str);
+    bool_changed = string_rope_replace(test_rope, "o", "0");
+    assert(!bool_changed);
+
+    for (i = 0; i < 1000; i++)
+    {
+        bool_changed = string_rope_concat_cstr(test_rope, "0123456789");
+        assert(bool_changed);
+    }
+
+    assert(string_rope_length(test_rope) == 10025 && string_rope_char_at(test_rope, 10024) == '9');
+    bool_changed = string_rope_concat(test_rope, test_rope);
+    assert(bool_changed && string_rope_length(test_rope) == 20050);
+    assert(string_rope_find_cstr(test_rope, "89The", 0) == 10023);
+    string_rope_destroy(test_rope);
+
+    /* a rope concatenated with itself over and over stays balanced--it used to grow into a spine and overflow the
+       stack. */
+    test_rope = string_rope_from_cstr("abcdefghij");
+
+    for (i = 0; i < 20; i++)
+    {
+        bool_changed = string_rope_concat(test_rope, test_rope);
+        assert(bool_changed && string_rope_length(test_rope) == 10 << (i + 1));
+        assert(string_rope_char_at(test_rope, 10 << i) == 'a' && string_rope_char_at(test_rope, (10 << i) - 1) == 'j');
+    }
+
+    for (i = 0; i < 100000; i++)
+        assert(string_rope_char_at(test_rope, i * 97 + 3) == 'a' + (i * 97 + 3) % 10);
+
+    string_rope_destroy(test_slice);
+    test_slice      =   string_rope_get_slice(test_rope, 5, 1005);
+    bool_changed    =   string_rope_insert(test_rope, 1000, test_slice);
+    assert(bool_changed && string_rope_length(test_rope) == (10 << 20) + 1000);
+    assert(string_rope_char_at(test_rope, 1000) == 'f' && string_rope_char_at(test_rope, 2000) == 'a');
+    string_rope_destroy(test_rope);
+
+    /* inserts scattered over the rope pack their text into shared chunks instead of a chunk each. */
+    test_rope = string_rope_init();
+
+    for (i = 0; i < 1000; i++)
+        string_rope_concat_cstr(test_rope, "0123456789");
+
+    string_get_alloc_stats(&stats_before);
+
+    for (i = 0; i < 1000; i++)
+    {
+        test_seed       =   test_seed * 1103515245u + 12345u;
+        bool_changed    =   string_rope_insert_cstr(test_rope, (int)((test_seed >> 8) % 10000u) + i, "#");
+        assert(bool_changed);
+    }
+
+    string_get_alloc_stats(&stats_after);
+    assert(string_rope_length(test_rope) == 11000 && string_rope_find_cstr(test_rope, "#", 0) != -1);
+    assert(stats_after.bytes_live - stats_before.bytes_live < 1000 * 256);
+
+    string_rope_destroy(test_rope);
+    string_rope_destroy(test_slice);
+    string_destroy(test_find_str);
+}
+
+void test_string_builder(void)
+{
+    string_builder_t* test_builder      =       string_builder_cust_init(8);
+    string_t* test_str                  =       string_init();
+    string_t* test_result               =       NULL;
+    string_alloc_stats_t stats_before, stats_after;
+    FILE* test_file                     =       tmpfile();
+    char test_buffer[64];
+    char* test_line                     =       NULL;
+    int i, bool_appended, bool_appended2, bool_appended3;
+
+    string_copy_cptr_sptr(test_str, "<li>");
+    bool_appended = string_builder_append_cstr(test_builder, "<ul>");
+    assert(bool_appended);
+
+    for (i = -1; i < 2; i++)
+    {
+        bool_appended   =   string_builder_append_string(test_builder, test_str);
+        bool_appended2  =   string_builder_append_int(test_builder, i * 1000);
+        bool_appended3  =   string_builder_append_char(test_builder, ';');
+        assert(bool_appended && bool_appended2 && bool_appended3);
+    }
+
+    bool_appended   =   string_builder_append_view(test_builder, string_view_from_cstr("</ul>"));
+    bool_appended2  =   string_builder_append_cstr(test_builder, NULL);
+    assert(bool_appended && !bool_appended2);
+    assert(string_builder_length(test_builder) == 34);
+
+    /* materializing takes exactly one allocation, however many chunks the text is spread across. */
+    string_get_alloc_stats(&stats_before);
+    test_result = string_builder_to_string(test_builder);
+    string_get_alloc_stats(&stats_after);
+    assert(stats_after.allocations == stats_before.allocations + 1);
+    assert(string_equal_cstring(test_result, "<ul><li>-1000;<li>0;<li>1000;</ul>"));
+    string_destroy(test_result);
+
+    /* writing to a stream does not build a string at all. */
+    if (test_file != NULL)
+    {
+        bool_appended = string_builder_write(test_builder, test_file);
+        assert(bool_appended);
+        rewind(test_file);
+        test_line = fgets(test_buffer, sizeof(test_buffer), test_file);
+        assert(test_line != NULL);
+        assert(strcmp(test_buffer, "<ul><li>-1000;<li>0;<li>1000;</ul>") == 0);
+        fclose(test_file);
+    }
+
+    /* a reset builder reuses its chunks. */
+    string_builder_reset(test_builder);
+    string_get_alloc_stats(&stats_before);
+    bool_appended   =   string_builder_append_cstr(test_builder, "0123456789abcdef");
+    bool_appended2  =   string_builder_append_int(test_builder, -9);
+    string_get_alloc_stats(&stats_after);
+    assert(bool_appended && bool_appended2);
+    assert(stats_after.allocations == stats_before.allocations);
+    test_result = string_builder_to_string(test_builder);
+    assert(string_equal_cstring(test_result, "0123456789abcdef-9"));
+
+    string_destroy(test_result);
+    string_destroy(test_str);
+    string_builder_destroy(test_builder);
+}
+
+void test_string_pattern(void)
+{
+    string_t* test_record           =       string_init();
+    string_pattern_t* test_short    =       string_pattern_compile("ERROR");
+    string_pattern_t* test_char     =       string_pattern_compile(";");
+    string_pattern_t* test_long     =       NULL;
+    string_pattern_t* test_dna      =       NULL;
+    string_alloc_stats_t stats_before, stats_after;
+    char test_needle[101];
+    char test_haystack[301];
+    int i;
+
+    test_long   =   string_pattern_compile("");
+    test_dna    =   string_pattern_compile(NULL);
+    assert(test_long == NULL && test_dna == NULL);
+
+    string_copy_cptr_sptr(test_record, "INFO ok; ERROR disk; WARN; ERROR net;");
+
+    /* searching with a compiled pattern never allocates. */
+    string_get_alloc_stats(&stats_before);
+    assert(string_pattern_find(test_short, test_record, 0) == 9);
+    assert(string_pattern_find(test_short, test_record, 10) == string_find_cstr(test_record, "ERROR", 10));
+    assert(string_pattern_find(test_short, test_record, 100) == -1 && string_pattern_find(test_short, NULL, 0) == -1);
+    assert(string_pattern_count(test_short, test_record) == 2 && string_pattern_count(test_char, test_record) == 4);
+    string_get_alloc_stats(&stats_after);
+    assert(stats_after.allocations == stats_before.allocations);
+
+    /* long needles over a large alphabet and over a small, repetitive one. */
+    for (i = 0; i < 100; i++)
+        test_needle[i] = (char)('!' + (i * 7) % 90);
+
+    test_needle[100]    =   '\0';
+    test_long           =   string_pattern_compile(test_needle);
+    sprintf(test_haystack, "%.99s%.100s%.100s", test_needle + 1, test_needle, test_needle);
+    string_copy_cptr_sptr(test_record, test_haystack);
+    assert(string_pattern_find(test_long, test_record, 0) == 99);
+    assert(string_pattern_find(test_long, test_record, 100) == 199 && string_pattern_count(test_long, test_record) == 2);
+
+    for (i = 0; i < 100; i++)
+        test_needle[i] = i % 10 == 9 ? 'C' : 'A';
+
+    test_dna = string_pattern_compile(test_needle);
+    sprintf(test_haystack, "%.99s%.99s%.100s", test_needle, test_needle, test_needle);
+    string_copy_cptr_sptr(test_record, test_haystack);
+    assert(string_pattern_find(test_dna, test_record, 0) == string_find_cstr(test_record, test_needle, 0));
+    assert(string_pattern_find(test_dna, test_record, 0) == 198 && string_pattern_count(test_dna, test_record) == 1);
+
+    string_pattern_destroy(test_short);
+    string_pattern_destroy(test_char);
+    string_pattern_destroy(test_long);
+    string_pattern_destroy(test_dna);
+    string_destroy(test_record);
+}
+
+static int test_record_match(int needle_id, int offset, void* context)
+{
+    int* test_matches = (int*)context;
+
+    test_matches[2 * test_matches[0] + 1]   =   needle_id;
+    test_matches[2 * test_matches[0] + 2]   =   offset;
+    test_matches[0]++;
+
+    return test_matches[0] == 8; /* stop once the array is full */
+}
+
+void test_string_multimatch(void)
+{
+    const char* test_keywords[]         =       {"he", "she", "his", "hers", "", NULL, "usher"};
+    string_multimatch_t* test_matcher   =       string_multimatch_init(test_keywords, 7);
+    string_t* test_record               =       string_init();
+    int test_matches[17]                =       {0};
+    string_multimatch_t* test_empty     =       string_multimatch_init(NULL, 0);
+    int test_needle_id                  =       -1;
+    int test_result;
+
+    assert(test_matcher != NULL && test_empty == NULL);
+
+    string_copy_cptr_sptr(test_record, "ushers");
+    assert(string_multimatch_any(test_matcher, test_record));
+    test_result = string_multimatch_find(test_matcher, test_record, &test_needle_id);
+    assert(test_result == 1 && test_needle_id == 1);
+
+    /* overlapping occurrences are reported in the order they end, longest first. */
+    test_result = string_multimatch_find_all(test_matcher, test_record, test_record_match, test_matches);
+    assert(test_result == 4);
+    assert(test_matches[0] == 4);
+    assert(test_matches[1] == 1 && test_matches[2] == 1);
+    assert(test_matches[3] == 0 && test_matches[4] == 2);
+    assert(test_matches[5] == 6 && test_matches[6] == 0);
+    assert(test_matches[7] == 3 && test_matches[8] == 2);
+    assert(string_multimatch_find_all(test_matcher, test_record, NULL, NULL) == 4);
+
+    /* empty and NULL needles never match. */
+    string_copy_cptr_sptr(test_record, "a quiet line");
+    assert(!string_multimatch_any(test_matcher, test_record));
+    test_result = string_multimatch_find(test_matcher, test_record, &test_needle_id);
+    assert(test_result == -1 && test_needle_id == -1);
+    assert(string_multimatch_find_all(test_matcher, test_record, NULL, NULL) == 0);
+
+    string_multimatch_destroy(test_matcher);
+    string_destroy(test_record);
+}
+
+void test_string_replace_all(void)
+{
+    string_t* test_str              =       string_init();
+    string_t* test_flat_str         =       string_flat_init(16);
+    string_alloc_stats_t stats_before, stats_after;
+    int num_replaced, num_replaced2;
+
+    string_copy_cptr_sptr(test_str, "a-b-c-d");
+    num_replaced = string_replace_all(test_str, "-", ", ");
+    assert(num_replaced == 3 && string_equal_cstring(test_str, "a, b, c, d"));
+    num_replaced = string_replace_all(test_str, ", ", "");
+    assert(num_replaced == 3 && string_equal_cstring(test_str, "abcd"));
+    num_replaced    =   string_replace_all(test_str, "x", "y");
+    num_replaced2   =   string_replace_all(test_str, "", "y");
+    assert(num_replaced == 0 && num_replaced2 == 0);
+    num_replaced    =   string_replace_all(test_str, NULL, "y");
+    num_replaced2   =   string_replace_all(NULL, "a", "b");
+    assert(num_replaced == 0 && num_replaced2 == 0);
+
+    /* occurrences do not overlap and replacement text is not searched again. */
+    string_copy_cptr_sptr(test_str, "aaaaa");
+    num_replaced = string_replace_all(test_str, "aa", "aaa");
+    assert(num_replaced == 2 && string_equal_cstring(test_str, "aaaaaaa"));
+
+    /* a result that fits the capacity is written in place, otherwise with exactly one allocation. */
+    string_copy_cptr_sptr(test_str, "{name} is {name}");
+    string_reserve(test_str, 64);
+    string_get_alloc_stats(&stats_before);
+    num_replaced = string_replace_all(test_str, "{name}", "Jason");
+    string_get_alloc_stats(&stats_after);
+    assert(num_replaced == 2);
+    assert(stats_after.allocations == stats_before.allocations && string_equal_cstring(test_str, "Jason is Jason"));
+    num_replaced = string_replace_all(test_str, "Jason", "a much longer name than the buffer holds, ");
+    string_get_alloc_stats(&stats_after);
+    assert(num_replaced == 2);
+    assert(stats_after.allocations == stats_before.allocations + 1 && test_str->capacity == test_str->length + 1);
+
+    string_copy_cptr_sptr(test_flat_str, "1.2.3");
+    num_replaced = string_replace_all_h(&test_flat_str, ".", "::");
+    assert(num_replaced == 2 && string_equal_cstring(test_flat_str, "1::2::3"));
+    assert(test_flat_str->char_array == test_flat_str->inline_buffer);
+
+    string_destroy(test_str);
+    string_destroy(test_flat_str);
+}
+
+void test_string_replace_many(void)
+{
+    string_replacement_t test_html[]        =       {{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}};
+    string_replacement_t test_longest[]     =       {{"a", "1"}, {"ab", "2"}, {"abc", "3"}, {"", "x"}, {NULL, "y"}};
+    string_replacement_t test_shrink[]      =       {{"\r\n", "\n"}, {"\t", " "}};
+    string_t* test_str                      =       string_init();
+    char* test_chars_before;
+    int num_replaced, num_replaced2;
+
+    string_copy_cptr_sptr(test_str, "<a href=\"x\">Tom & Jerry</a>");
+    num_replaced = string_replace_many(test_str, test_html, 4);
+    assert(num_replaced == 7);
+    assert(string_equal_cstring(test_str, "&lt;a href=&quot;x&quot;&gt;Tom &amp; Jerry&lt;/a&gt;"));
+
+    /* replacement text is not scanned again, so escaping twice escapes the ampersands once more. */
+    num_replaced = string_replace_many(test_str, test_html, 4);
+    assert(num_replaced == 7);
+    assert(string_in(test_str, "&amp;lt;a") && string_in(test_str, "Tom &amp;amp; Jerry"));
+
+    /* the longest match at each position wins. */
+    string_copy_cptr_sptr(test_str, "abcabaxa");
+    num_replaced = string_replace_many(test_str, test_longest, 5);
+    assert(num_replaced == 4 && string_equal_cstring(test_str, "321x1"));
+
+    /* tables that never lengthen the text are applied in place. */
+    string_copy_cptr_sptr(test_str, "line one\r\n\tline two\r\n");
+    test_chars_before = test_str->char_array;
+    num_replaced = string_replace_many(test_str, test_shrink, 2);
+    assert(num_replaced == 3 && string_equal_cstring(test_str, "line one\n line two\n"));
+    assert(test_str->char_array == test_chars_before);
+
+    num_replaced    =   string_replace_many(test_str, test_html, 0);
+    num_replaced2   =   string_replace_many(NULL, test_html, 4);
+    assert(num_replaced == 0 && num_replaced2 == 0);
+
+    string_destroy(test_str);
+}
+
+void test_string_splice(void)
+{
+    string_t* test_str          =       string_init();
+    string_t* test_flat         =       string_flat_init(8);
+    string_t* test_copy         =       string_init();
+    string_t* test_immutable    =       string_intern_cstr("immutable");
+    string_alloc_stats_t stats_before, stats_after;
+    int bool_changed, bool_changed2, bool_changed3;
+
+    string_copy_cptr_sptr(test_str, "Hello world");
+
+    bool_changed = string_insert(test_str, 5, ",");
+    assert(bool_changed);
+    assert(string_equal_cstring(test_str, "Hello, world") && test_str->length == 12);
+    bool_changed    =   string_insert(test_str, 0, ">> ");
+    bool_changed2   =   string_insert(test_str, test_str->length, "!");
+    assert(bool_changed && bool_changed2);
+    assert(string_equal_cstring(test_str, ">> Hello, world!"));
+
+    bool_changed = string_erase(test_str, 0, 3);
+    assert(bool_changed && string_equal_cstring(test_str, "Hello, world!"));
+    bool_changed = string_erase(test_str, 5, 1000);
+    assert(bool_changed && string_equal_cstring(test_str, "Hello") && test_str->length == 5);
+
+    /* replacing with a longer, a shorter and an equally long run. */
+    bool_changed = string_splice(test_str, 1, 3, "ipp", 3);
+    assert(bool_changed && string_equal_cstring(test_str, "Hippo"));
+    bool_changed = string_splice(test_str, 1, 1, "a very long replacement for the inline buffer ", 46);
+    assert(bool_changed);
+    assert(string_equal_cstring(test_str, "Ha very long replacement for the inline buffer ppo") && test_str->length == 50);
+    bool_changed = string_splice(test_str, 1, 46, "e", 1);
+    assert(bool_changed && string_equal_cstring(test_str, "Heppo"));
+
+    /* the inserted characters may come from the string itself. */
+    bool_changed = string_splice(test_str, 0, 0, test_str->char_array + 1, 4);
+    assert(bool_changed && string_equal_cstring(test_str, "eppoHeppo"));
+    bool_changed = string_splice(test_str, 4, 5, test_str->char_array, 4);
+    assert(bool_changed && string_equal_cstring(test_str, "eppoeppo"));
+
+    /* bad ranges and arguments are refused without changing anything. */
+    bool_changed    =   string_splice(test_str, -1, 0, "x", 1);
+    bool_changed2   =   string_splice(test_str, 9, 0, "x", 1);
+    assert(!bool_changed && !bool_changed2);
+    bool_changed    =   string_splice(test_str, 0, -1, "x", 1);
+    bool_changed2   =   string_splice(test_str, 0, 0, NULL, 1);
+    assert(!bool_changed && !bool_changed2);
+    bool_changed    =   string_insert(test_str, 0, NULL);
+    bool_changed2   =   string_insert(NULL, 0, "x");
+    bool_changed3   =   string_erase(NULL, 0, 1);
+    assert(!bool_changed && !bool_changed2 && !bool_changed3);
+    bool_changed = string_insert(test_immutable, 0, "x");
+    assert(!bool_changed);
+    assert(string_equal_cstring(test_str, "eppoeppo"));
+
+    /* a string object sharing its characters gets its own copy in the same step that grows it. */
+    string_set_copy_on_write(1);
+    string_copy_cptr_sptr(test_str, "A payload that is much too long for the inline buffer.");
+    string_copy_sptr(test_copy, test_str);
+    string_get_alloc_stats(&stats_before);
+    bool_changed = string_insert(test_copy, 9, ", whose copy is bigger,");
+    string_get_alloc_stats(&stats_after);
+    assert(bool_changed);
+    assert(stats_after.allocations == stats_before.allocations + 1);
+    assert(string_equal_cstring(test_copy, "A payload, whose copy is bigger, that is much too long for the inline buffer."));
+    assert(string_equal_cstring(test_str, "A payload that is much too long for the inline buffer."));
+    string_set_copy_on_write(0);
+
+    /* flat string objects grow as a whole through their handles. */
+    bool_changed    =   string_insert_h(&test_flat, 0, "flat");
+    bool_changed2   =   string_insert_h(&test_flat, 4, " and longer than eight");
+    assert(bool_changed && bool_changed2);
+    assert(string_equal_cstring(test_flat, "flat and longer than eight"));
+    assert(test_flat->char_array == test_flat->inline_buffer);
+    bool_changed    =   string_splice_h(&test_flat, 0, 4, test_flat->char_array + 9, 6);
+    bool_changed2   =   string_erase(test_flat, 6, 4);
+    assert(bool_changed && bool_changed2);
+    assert(string_equal_cstring(test_flat, "longer longer than eight"));
+
+    string_intern_cleanup();
+    string_destroy(test_str);
+    string_destroy(test_flat);
+    string_destroy(test_copy);
+}
+
+void test_string_case(void)
+{
+    string_t* test_str          =       string_init();
+    string_t* test_copy         =       string_init();
+    string_t* test_key          =       string_init();
+    char test_chars[200];
+    int bool_changed, bool_changed2;
+    int i;
+
+    /* long enough for the vector kernels and their tails; bytes outside ASCII are left alone. */
+    for (i = 0; i < 199; i++)
+        test_chars[i] = (char)("aZ@[`{09\xc4\xe4-_"[i % 12]);
+    test_chars[199] = '\0';
+    string_copy_cptr_sptr(test_str, test_chars);
+
+    bool_changed = string_toupper_copy(test_copy, test_str);
+    assert(bool_changed);
+    assert(test_copy->length == 199 && test_copy->char_array[199] == '\0');
+    for (i = 0; i < 199; i++)
+        assert(test_copy->char_array[i] == (test_chars[i] == 'a' ? 'A' : test_chars[i]));
+    assert(string_equal_cstring(test_str, test_chars));
+
+    bool_changed = string_tolower_copy(test_copy, test_copy);
+    assert(bool_changed);
+    for (i = 0; i < 199; i++)
+        assert(test_copy->char_array[i] == (test_chars[i] == 'Z' ? 'z' : test_chars[i]));
+
+    /* the stored length is used, so characters after an embedded null character are converted too. */
+    string_copy_cptr_sptr(test_str, "ab?cd");
+    test_str->char_array[2] = '\0';
+    string_toupper(test_str);
+    assert(memcmp(test_str->char_array, "AB\0CD", 6) == 0);
+
+    /* case-insensitive comparison and hashing. */
+    string_copy_cptr_sptr(test_key, "Content-Type: Application/JSON; Charset=UTF-8; Boundary=X");
+    string_tolower_copy(test_copy, test_key);
+    assert(string_equal_ci(test_key, test_copy) && !string_equal(test_key, test_copy));
+    assert(string_hash_ci(test_key) == string_hash_ci(test_copy));
+    test_copy->char_array[50] = 'y';
+    assert(!string_equal_ci(test_key, test_copy) && string_hash_ci(test_key) != string_hash_ci(test_copy));
+
+    /* '@' and '`' differ by the case bit but are not letters. */
+    assert(!string_view_equal_ci(string_view_from_cstr("a@"), string_view_from_cstr("A`")));
+    assert(string_view_equal_ci(string_view_from_cstr("X-Forwarded-For"), string_view_from_cstr("x-forwarded-for")));
+    assert(!string_view_equal_ci(string_view_from_cstr("abc"), string_view_from_cstr("abcd")));
+    assert(string_view_hash_ci(string_view_from_cstr("HOST")) == string_view_hash_ci(string_view_from_cstr("host")));
+    assert(string_view_hash_ci(string_view_from_cstr("host")) != string_view_hash_ci(string_view_from_cstr("hosts")));
+    assert(string_equal_ci(NULL, NULL) && !string_equal_ci(test_key, NULL));
+    bool_changed    =   string_tolower_copy(NULL, test_key);
+    bool_changed2   =   string_toupper_copy(test_copy, NULL);
+    assert(!bool_changed && !bool_changed2);
+
+    string_destroy(test_str);
+    string_destroy(test_copy);
+    string_destroy(test_key);
+}
+
+void test_string_charset(void)
+{
+    int (*test_ctype[STRING_CLASS_COUNT])(int) = {isalpha, isdigit, isalnum, isxdigit, isupper, islower, isspace,
+                                                  ispunct, iscntrl, isprint};
+    string_charset_t test_set;
+    string_t* test_str          =       string_init();
+    char test_chars[100];
+    int test_offender, bool_all_in, i, j;
+
+    /* the predefined classes match the C locale's. */
+    for (i = 0; i < STRING_CLASS_COUNT; i++)
+    {
+        for (j = 0; j < 256; j++)
+        {
+            assert(string_charset_contains(string_charset_class(i), (unsigned char)j)
+                   == (j < 128 && test_ctype[i](j) != 0));
+        }
+    }
+    assert(string_charset_class(-1) == NULL && string_charset_class(STRING_CLASS_COUNT) == NULL);
+
+    /* user defined sets, including bytes outside ASCII. */
+    string_charset_clear(&test_set);
+    string_charset_add_range(&test_set, 'a', 'f');
+    string_charset_add_chars(&test_set, "_\xe9");
+    string_charset_add(&test_set, 0xff);
+    assert(string_charset_contains(&test_set, 'c') && string_charset_contains(&test_set, '_'));
+    assert(string_charset_contains(&test_set, 0xe9) && string_charset_contains(&test_set, 0xff));
+    assert(!string_charset_contains(&test_set, 'g') && !string_charset_contains(&test_set, 0x69));
+
+    /* the first offender is found wherever it is, by the vector kernels and their tails alike. */
+    for (i = 0; i < 99; i++)
+        test_chars[i] = "abc_\xe9\xff"[i % 6];
+    test_chars[99] = '\0';
+    string_copy_cptr_sptr(test_str, test_chars);
+    bool_all_in = string_all_in(test_str, &test_set, &test_offender);
+    assert(bool_all_in && test_offender == 99);
+
+    for (i = 0; i < 99; i++)
+    {
+        test_str->char_array[i] = (char)(i % 2 ? 'z' : 0x69);
+        bool_all_in = string_all_in(test_str, &test_set, &test_offender);
+        assert(!bool_all_in && test_offender == i);
+        test_str->char_array[i] = test_chars[i];
+    }
+
+    string_charset_invert(&test_set);
+    assert(!string_charset_contains(&test_set, 'a') && string_charset_contains(&test_set, 'z'));
+    bool_all_in = string_view_all_in(string_view_from_cstr("zz-a"), &test_set, &test_offender);
+    assert(!bool_all_in && test_offender == 3);
+    assert(string_view_all_in(string_view_from_cstr(""), &test_set, NULL));
+    bool_all_in = string_view_all_in(string_view_from_cstr("a"), NULL, &test_offender);
+    assert(!bool_all_in && test_offender == 0);
+
+    /* the predicates built upon the classes. */
+    assert(string_view_isalpha(string_view_from_cstr("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ")));
+    assert(!string_view_isalpha(string_view_from_cstr("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0")));
+    assert(string_view_isnonalpha(string_view_from_cstr("0123456789 !@#$%^&*()-=_+[]{};:'\",.<>/?\\|`~ \xc4")));
+    assert(string_view_is_int(string_view_from_cstr("-1234567890123456789012345678901234567890")));
+    assert(!string_view_is_int(string_view_from_cstr("12345678901234567890123456789012345678901-")));
+
+    string_destroy(test_str);
+}
+
+void test_string_filter(void)
+{
+    string_t* test_str          =       string_init();
+    char test_chars[400];
+    char test_expected[400];
+    char* test_chars_before;
+    int i, test_kept, num_removed, num_removed2, num_removed3;
+
+    string_copy_cptr_sptr(test_str, "  Hello,\tworld!  \r\n");
+    num_removed = string_filter(test_str, string_charset_class(STRING_CLASS_SPACE), 0);
+    assert(num_removed == 7);
+    assert(string_equal_cstring(test_str, "Hello,world!"));
+    num_removed = string_filter(test_str, string_charset_class(STRING_CLASS_PUNCT), 0);
+    assert(num_removed == 2);
+    assert(string_equal_cstring(test_str, "Helloworld") && test_str->length == 10);
+
+    /* long punctuation-heavy input, compacted in place by the vector kernels and their tails. */
+    for (i = 0, test_kept = 0; i < 399; i++)
+    {
+        test_chars[i] = "a1 .b,,C;\xe9Z9"[i % 12];
+        if (isalpha((unsigned char)test_chars[i]))
+            test_expected[test_kept++] = test_chars[i];
+    }
+    test_chars[399]             =   '\0';
+    test_expected[test_kept]    =   '\0';
+
+    string_copy_cptr_sptr(test_str, test_chars);
+    test_chars_before = test_str->char_array;
+    string_remove_nonalpha(test_str);
+    assert(string_equal_cstring(test_str, test_expected) && test_str->length == test_kept);
+    assert(test_str->char_array == test_chars_before);
+
+    string_copy_cptr_sptr(test_str, test_chars);
+    num_removed = string_filter(test_str, string_charset_class(STRING_CLASS_ALPHA), 0);
+    assert(num_removed == test_kept);
+    assert(test_str->length == 399 - test_kept && string_view_isnonalpha(string_view_from_string(test_str)));
+
+    num_removed     =   string_filter(test_str, string_charset_class(STRING_CLASS_ALPHA), 0);
+    num_removed2    =   string_filter(test_str, NULL, 1);
+    num_removed3    =   string_filter(NULL, string_charset_class(STRING_CLASS_ALPHA), 1);
+    assert(num_removed == 0 && num_removed2 == 0 && num_removed3 == 0);
+
+    string_destroy(test_str);
+}
+
+void test_string_charset_span(void)
+{
+    string_charset_t test_ident, test_set;
+    string_t* test_str          =       string_init();
+    int bool_valid, bool_valid2, num_trimmed, num_trimmed2;
+    int i;
+
+    bool_valid = string_charset_from_spec(&test_ident, "a-zA-Z0-9_");
+    assert(bool_valid);
+    for (i = 0; i < 256; i++)
+        assert(string_charset_contains(&test_ident, (unsigned char)i) == (i < 128 && (isalnum(i) || i == '_')));
+
+    /* '-' stands for itself at either end, a backslash escapes and '^' inverts. */
+    bool_valid = string_charset_from_spec(&test_set, "-+0-9.eE-");
+    assert(bool_valid && string_charset_contains(&test_set, '-'));
+    assert(string_charset_contains(&test_set, '5') && !string_charset_contains(&test_set, ','));
+    bool_valid = string_charset_from_spec(&test_set, "a\\-c");
+    assert(bool_valid && string_charset_contains(&test_set, '-'));
+    assert(!string_charset_contains(&test_set, 'b'));
+    bool_valid = string_charset_from_spec(&test_set, "^\\^");
+    assert(bool_valid && !string_charset_contains(&test_set, '^'));
+    assert(string_charset_contains(&test_set, 'x') && string_charset_contains(&test_set, 0xff));
+    bool_valid = string_charset_from_spec(&test_set, "z-a");
+    assert(!bool_valid && !string_charset_contains(&test_set, 'm'));
+    bool_valid      =   string_charset_from_spec(&test_set, "ab\\");
+    bool_valid2     =   string_charset_from_spec(NULL, "a");
+    assert(!bool_valid && !bool_valid2);
+
+    /* spans and searches, over stretches long enough for the vector kernels. */
+    string_copy_cptr_sptr(test_str, "  \t first_identifier_of_a_rather_long_line = value_2 + other;\r\n");
+    assert(string_span(test_str, string_charset_class(STRING_CLASS_SPACE), 0) == 4);
+    assert(string_span(test_str, &test_ident, 4) == 38 && string_cspan(test_str, &test_ident, 42) == 3);
+    assert(string_find_first_of(test_str, string_charset_class(STRING_CLASS_PUNCT), 0) == 9);
+    assert(string_find_first_of(test_str, string_charset_class(STRING_CLASS_DIGIT), 0) == 51);
+    assert(string_find_first_of(test_str, string_charset_class(STRING_CLASS_UPPER), 0) == -1);
+    assert(string_find_last_of(test_str, &test_ident, test_str->length) == 59);
+    assert(string_find_last_of(test_str, string_charset_class(STRING_CLASS_PUNCT), 100) == 60);
+    assert(string_find_last_of(test_str, string_charset_class(STRING_CLASS_PUNCT), 60) == 53);
+    assert(string_find_last_of(test_str, string_charset_class(STRING_CLASS_UPPER), 60) == -1);
+    assert(string_span(test_str, &test_ident, -1) == 0 && string_find_first_of(test_str, NULL, 0) == -1);
+
+    /* the predicates are spans over the whole string. */
+    assert(string_isalpha(test_str) == (string_span(test_str, string_charset_class(STRING_CLASS_ALPHA), 0)
+                                        == test_str->length));
+
+    /* trimming, white space by default. */
+    num_trimmed = string_trim(test_str, NULL);
+    assert(num_trimmed == 6);
+    assert(string_equal_cstring(test_str, "first_identifier_of_a_rather_long_line = value_2 + other;"));
+    num_trimmed = string_rtrim(test_str, string_charset_class(STRING_CLASS_PUNCT));
+    assert(num_trimmed == 1);
+    num_trimmed = string_ltrim(test_str, &test_ident);
+    assert(num_trimmed == 38 && string_equal_cstring(test_str, " = value_2 + other"));
+    string_copy_cptr_sptr(test_str, "\t\t  \n");
+    num_trimmed = string_trim(test_str, NULL);
+    assert(num_trimmed == 5 && test_str->length == 0 && test_str->char_array[0] == '\0');
+    num_trimmed     =   string_trim(test_str, NULL);
+    num_trimmed2    =   string_trim(NULL, NULL);
+    assert(num_trimmed == 0 && num_trimmed2 == 0);
+
+    string_destroy(test_str);
+}
+
+void test_string_hash(void)
+{
+    string_t* test_str1         =       string_init();
+    string_t* test_str2         =       string_init();
+    string_t* test_interned     =       NULL;
+    unsigned long long test_hashes[101];
+    char test_chars[101];
+    unsigned long long test_hash, test_hash2;
+    int i, j;
+
+    /* every prefix of a string--covering each of the hash's length cases--hashes differently. */
+    for (i = 0; i < 100; i++)
+        test_chars[i] = (char)('a' + i % 7);
+    test_chars[100] = '\0';
+    for (i = 0; i <= 100; i++)
+    {
+        test_hashes[i] = string_view_hash(string_view_slice(string_view_from_cstr(test_chars), 0, i));
+        for (j = 0; j < i; j++)
+            assert(test_hashes[i] != test_hashes[j]);
+    }
+
+    /* equal contents hash the same however they are stored, and the hash is cached. */
+    string_copy_cptr_sptr(test_str1, "Content-Length");
+    string_copy_cptr_sptr(test_str2, "Content-Length");
+    test_hash = string_hash(test_str1);
+    test_hash2 = string_hash(test_str2);
+    assert(test_hash == test_hash2 && test_hash == string_view_hash(string_view_from_cstr("Content-Length")));
+    assert(test_str1->flags & STRING_FLAG_HASHED);
+    assert(string_view_hash_seeded(string_view_from_cstr("Content-Length"), 42) != test_hash);
+
+    /* every mutating function drops the cached hash. */
+    string_concat(test_str2, test_str1);
+    assert(!(test_str2->flags & STRING_FLAG_HASHED));
+    test_hash2 = string_hash(test_str2);
+    assert(test_hash2 != test_hash);
+    string_insert(test_str2, 0, "x");
+    test_hash2 = string_hash(test_str2);
+    assert(test_hash2 == string_view_hash(string_view_from_string(test_str2)));
+    string_erase(test_str2, 0, 1);
+    string_replace_all(test_str2, "Length", "Type");
+    test_hash2 = string_hash(test_str2);
+    assert(test_hash2 == string_view_hash(string_view_from_cstr("Content-TypeContent-Type")));
+    string_copy_sptr(test_str2, test_str1);
+    test_hash2 = string_hash(test_str2);
+    assert(test_hash2 == test_hash);
+
+    /* unequal cached hashes settle string_equal() at once; equal ones still compare the characters. */
+    string_copy_cptr_sptr(test_str2, "Content-Lengtx");
+    string_hash(test_str2);
+    assert(!string_equal(test_str1, test_str2));
+    string_copy_cptr_sptr(test_str2, "Content-Length");
+    assert(string_equal(test_str1, test_str2));
+
+    /* interned strings are hashed when they are interned. */
+    test_interned = string_intern(test_str1);
+    assert((test_interned->flags & STRING_FLAG_HASHED) && string_hash(test_interned) == test_hash);
+    assert(string_hash(NULL) == string_view_hash(string_view_from_cstr(NULL)));
+
+    string_intern_cleanup();
+    string_destroy(test_str1);
+    string_destroy(test_str2);
+}
+
+void test_string_map(void)
+{
+    string_map_t* test_map      =       string_map_init();
+    string_map_t* test_counts   =       string_map_cust_init(sizeof(int));
+    string_t* test_key          =       string_init();
+    char test_buffer[64];
+    string_view_t test_view;
+    void* test_value;
+    void* test_slot;
+    int* test_count;
+    int bool_changed, bool_changed2, bool_more;
+    int test_inserted, test_iter, test_total, i;
+
+    /* pointer values, keyed by C strings, views and string objects alike */
+    assert(string_map_size(test_map) == 0 && string_map_get(test_map, "missing") == NULL);
+    bool_changed    =   string_map_put(test_map, "alpha", test_buffer);
+    bool_changed2   =   string_map_put(test_map, "a key longer than sixteen", test_map);
+    assert(bool_changed && bool_changed2);
+    assert(string_map_get(test_map, "alpha") == test_buffer && string_map_size(test_map) == 2);
+    bool_changed = string_map_put(test_map, "alpha", NULL);
+    assert(bool_changed && string_map_size(test_map) == 2);
+    assert(string_map_get(test_map, "alpha") == NULL && string_map_find_cstr(test_map, "alpha") != NULL);
+    string_copy_cptr_sptr(test_key, "a key longer than sixteen");
+    assert(*(string_map_t**)string_map_find(test_map, test_key) == test_map);
+    test_view = string_view_slice(string_view_from_cstr("alphabet"), 0, 5);
+    assert(string_map_find_view(test_map, test_view) != NULL);
+    assert(string_map_find_cstr(test_map, "alph") == NULL && string_map_find_cstr(test_map, "") == NULL);
+    bool_changed    =   string_map_erase(test_map, test_key);
+    bool_changed2   =   string_map_erase(test_map, test_key);
+    assert(bool_changed && !bool_changed2);
+    assert(string_map_size(test_map) == 1 && string_map_find(test_map, test_key) == NULL);
+    test_slot = string_map_insert_cstr(test_map, NULL, &test_inserted);
+    assert(test_slot == NULL && !test_inserted);
+
+    /* fixed-size values: count words, growing the table from empty through several rebuilds */
+    for (i = 0; i < 3000; i++)
+    {
+        sprintf(test_buffer, i / 1000 == 1 ? "word %d" : "a considerably longer word %d", i % 1000);
+        test_count = (int*)string_map_insert_cstr(test_counts, test_buffer, &test_inserted);
+        assert(test_count != NULL && test_inserted == (i < 2000 ? 1 : 0) && *test_count == (i < 2000 ? 0 : 1));
+        (*test_count)++;
+    }
+    assert(string_map_size(test_counts) == 2000);
+    assert(*(int*)string_map_find_cstr(test_counts, "word 999") == 1);
+    assert(*(int*)string_map_find_cstr(test_counts, "a considerably longer word 999") == 2);
+
+    /* erase every other word, including while iterating, then look the survivors up again */
+    for (i = 0; i < 1000; i += 2)
+    {
+        sprintf(test_buffer, "a considerably longer word %d", i);
+        bool_changed = string_map_erase_cstr(test_counts, test_buffer);
+        assert(bool_changed);
+    }
+    test_iter   =   0;
+    test_total  =   0;
+    while (string_map_next(test_counts, &test_iter, &test_view, &test_value))
+    {
+        assert(test_view.chars[test_view.length] == '\0' && string_map_find_view(test_counts, test_view) == test_value);
+        test_total += *(int*)test_value;
+
+        if (string_view_in(test_view, "longer"))
+        {
+            bool_changed = string_map_erase_view(test_counts, test_view);
+            assert(bool_changed);
+        }
+    }
+    assert(test_total == 1000 + 500 * 2 && string_map_size(test_counts) == 1000);
+    assert(string_map_find_cstr(test_counts, "a considerably longer word 1") == NULL);
+
+    /* reserve() makes room up front; clear() keeps the table for reuse */
+    bool_changed = string_map_reserve(test_counts, 100000);
+    assert(bool_changed);
+    for (i = 0; i < 100; i++)
+    {
+        sprintf(test_buffer, "%d", i);
+        string_copy_cptr_sptr(test_key, test_buffer);
+        *(int*)string_map_insert(test_counts, test_key, NULL) = i;
+    }
+    assert(*(int*)string_map_find_cstr(test_counts, "42") == 42 && string_map_size(test_counts) == 1100);
+    string_map_clear(test_counts);
+    assert(string_map_size(test_counts) == 0 && string_map_find_cstr(test_counts, "42") == NULL);
+    test_iter   =   0;
+    bool_more   =   string_map_next(test_counts, &test_iter, NULL, NULL);
+    assert(!bool_more);
+
+    string_map_destroy(test_map);
+    string_map_destroy(test_counts);
+    string_destroy(test_key);
+}
+
+void test_string_compare(void)
+{
+    string_t* test_str1         =       string_init();
+    string_t* test_str2         =       string_init();
+    const char* test_sorted[]   =       {"42", "Apple", "Banana", "apple", "apple pie", "apples", "b", "\xe9t\xe9"};
+    int i, j;
+
+    /* byte order, prefixes first, high bytes after ASCII */
+    for (i = 0; i < 8; i++)
+    {
+        string_copy_cptr_sptr(test_str1, test_sorted[i]);
+
+        for (j = 0; j < 8; j++)
+        {
+            string_copy_cptr_sptr(test_str2, test_sorted[j]);
+            assert((string_compare(test_str1, test_str2) < 0) == (i < j));
+            assert((string_compare(test_str1, test_str2) > 0) == (i > j));
+            assert((string_compare_cstr(test_str1, test_sorted[j]) == 0) == (i == j));
+            assert(string_equal(test_str1, test_str2) == (i == j));
+        }
+    }
+
+    /* binary safe: an embedded null character is compared like any other byte */
+    string_copy_cptr_sptr(test_str1, "abc");
+    string_splice(test_str1, 1, 0, "\0", 1);
+    string_copy_cptr_sptr(test_str2, "a");
+    assert(string_compare(test_str1, test_str2) > 0 && string_compare_cstr(test_str1, "a") > 0);
+    assert(string_compare_cstr(test_str1, "ab") < 0 && !string_equal(test_str1, test_str2));
+    string_splice(test_str2, 1, 0, "\0bd", 3);
+    assert(string_compare(test_str1, test_str2) < 0 && string_compare(test_str2, test_str1) > 0);
+    string_splice(test_str2, 3, 1, "c", 1);
+    assert(string_compare(test_str1, test_str2) == 0 && string_equal(test_str1, test_str2));
+    assert(string_compare(test_str1, test_str1) == 0 && string_equal(test_str1, test_str1));
+
+    /* NULL sorts first */
+    assert(string_compare(NULL, NULL) == 0 && string_equal(NULL, NULL) && !string_equal(test_str1, NULL));
+    assert(string_compare(NULL, test_str1) < 0 && string_compare(test_str1, NULL) > 0);
+    assert(string_compare_cstr(NULL, "") < 0 && string_compare_cstr(test_str1, NULL) > 0);
+
+    /* case-insensitive order, on both sides of the vector kernels' block sizes */
+    string_copy_cptr_sptr(test_str1, "The Quick Brown Fox Jumps Over The Lazy Dog, Again And Again [1]");
+    string_copy_cptr_sptr(test_str2, "the quick brown fox jumps over the lazy dog, again and again [1]");
+    assert(string_compare_ci(test_str1, test_str2) == 0 && string_compare(test_str1, test_str2) < 0);
+    string_set_range(test_str2, "{", 62, 62);
+    assert(string_compare_ci(test_str1, test_str2) < 0 && string_compare_ci(test_str2, test_str1) > 0);
+    string_copy_cptr_sptr(test_str2, "THE QUICK");
+    assert(string_compare_ci(test_str1, test_str2) > 0 && string_compare_ci(test_str2, test_str1) < 0);
+    string_copy_cptr_sptr(test_str1, "a_");
+    string_copy_cptr_sptr(test_str2, "A[");
+    assert(string_compare_ci(test_str1, test_str2) > 0 && string_compare(test_str1, test_str2) > 0);
+    string_copy_cptr_sptr(test_str2, "Ab");
+    assert(string_compare_ci(test_str1, test_str2) < 0 && string_compare(test_str1, test_str2) > 0);
+    assert(string_compare_ci(NULL, test_str2) < 0 && string_compare_ci(NULL, NULL) == 0);
+
+    string_destroy(test_str1);
+    string_destroy(test_str2);
+}
+
+void test_string_to_int64(void)
+{
+    string_t* test_str          =       string_init();
+    long long test_value        =       0;
+    unsigned long long test_uvalue  =   0;
+    int test_status;
+
+    /* decimal, on both sides of the 8-digit steps */
+    string_copy_cptr_sptr(test_str, "1234567");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_OK && test_value == 1234567);
+    string_copy_cptr_sptr(test_str, "-123456789012345678");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_OK && test_value == -123456789012345678LL);
+    string_copy_cptr_sptr(test_str, "+0000000000000000000000042");
+    test_status = string_to_int64(test_str, &test_value, 0);
+    assert(test_status == STRING_NUM_OK && test_value == 42);
+
+    /* the limits, and one past them */
+    string_copy_cptr_sptr(test_str, "9223372036854775807");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_OK && test_value == LLONG_MAX);
+    string_copy_cptr_sptr(test_str, "-9223372036854775808");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_OK && test_value == LLONG_MIN);
+    string_copy_cptr_sptr(test_str, "9223372036854775808");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_OVERFLOW && test_value == LLONG_MIN);
+    test_status = string_to_uint64(test_str, &test_uvalue, 10);
+    assert(test_status == STRING_NUM_OK && test_uvalue == 9223372036854775808ULL);
+    string_copy_cptr_sptr(test_str, "18446744073709551615");
+    test_status = string_to_uint64(test_str, &test_uvalue, 10);
+    assert(test_status == STRING_NUM_OK && test_uvalue == ULLONG_MAX);
+    string_copy_cptr_sptr(test_str, "18446744073709551616");
+    test_status = string_to_uint64(test_str, &test_uvalue, 10);
+    assert(test_status == STRING_NUM_OVERFLOW);
+    string_copy_cptr_sptr(test_str, "-1");
+    test_status = string_to_uint64(test_str, &test_uvalue, 10);
+    assert(test_status == STRING_NUM_OVERFLOW && test_uvalue == ULLONG_MAX);
+    string_copy_cptr_sptr(test_str, "-0");
+    test_status = string_to_uint64(test_str, &test_uvalue, 10);
+    assert(test_status == STRING_NUM_OK && test_uvalue == 0);
+
+    /* other bases, with and without prefixes */
+    string_copy_cptr_sptr(test_str, "0xDeadBeef");
+    test_status = string_to_int64(test_str, &test_value, 0);
+    assert(test_status == STRING_NUM_OK && test_value == 0xdeadbeefLL);
+    test_status = string_to_int64(test_str, &test_value, 16);
+    assert(test_status == STRING_NUM_OK && test_value == 0xdeadbeefLL);
+    test_status = string_to_int64(test_str, NULL, 10);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "0b101");
+    test_status = string_to_int64(test_str, &test_value, 16);
+    assert(test_status == STRING_NUM_OK && test_value == 0xb101);
+    test_status = string_to_int64(test_str, &test_value, 0);
+    assert(test_status == STRING_NUM_OK && test_value == 5);
+    string_copy_cptr_sptr(test_str, "-0o777");
+    test_status = string_to_int64(test_str, &test_value, 8);
+    assert(test_status == STRING_NUM_OK && test_value == -511);
+    string_copy_cptr_sptr(test_str, "ffffffffffffffff");
+    test_status = string_to_uint64(test_str, &test_uvalue, 16);
+    assert(test_status == STRING_NUM_OK && test_uvalue == ULLONG_MAX);
+    test_status = string_to_int64(test_str, &test_value, 16);
+    assert(test_status == STRING_NUM_OVERFLOW);
+    string_copy_cptr_sptr(test_str, "1ffffffffffffffff");
+    test_status = string_to_uint64(test_str, &test_uvalue, 16);
+    assert(test_status == STRING_NUM_OVERFLOW);
+
+    /* malformed numbers are invalid, even past an overflow */
+    string_copy_cptr_sptr(test_str, "123456789012345678901234567890x");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "1234567/");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, " 42");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "0x");
+    test_status = string_to_int64(test_str, &test_value, 0);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "-");
+    test_status = string_to_int64(test_str, &test_value, 10);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "12");
+    test_status = string_to_int64(test_str, &test_value, 12);
+    assert(test_status == STRING_NUM_INVALID);
+    test_status = string_to_int64(NULL, &test_value, 10);
+    assert(test_status == STRING_NUM_INVALID && test_value == -511);
+    test_status = string_view_to_int64(string_view_slice(string_view_from_cstr("2-1"), 0, 1), &test_value, 10);
+    assert(test_status == STRING_NUM_OK && test_value == 2);
+
+    /* string_toint() reports out of range values instead of wrapping around */
+    string_copy_cptr_sptr(test_str, "-2147483648");
+    assert(string_toint(test_str) == INT_MIN);
+    string_copy_cptr_sptr(test_str, "2147483648");
+    assert(string_toint(test_str) == -3);
+
+    string_destroy(test_str);
+}
+
+void test_string_double(void)
+{
+    string_t* test_str          =       string_init();
+    double test_value           =       0.0;
+    double tiny                 =       4.9406564584124654e-324;
+    string_t* interned_str      =       NULL;
+    string_t* interned_again    =       NULL;
+    int test_status, bool_changed, bool_changed2;
+    int idx;
+
+    /* the fast paths, and the digit counts around them */
+    string_copy_cptr_sptr(test_str, "1.5");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 1.5);
+    string_copy_cptr_sptr(test_str, "-12345678.125e-3");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == -12345.678125);
+    string_copy_cptr_sptr(test_str, "1e23");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 1e23);
+    string_copy_cptr_sptr(test_str, ".5E+1");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 5.0);
+    string_copy_cptr_sptr(test_str, "7.");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 7.0);
+    string_copy_cptr_sptr(test_str, "2.2250738585072011e-308");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 2.2250738585072011e-308);
+
+    /* exact halfway cases round to even; any digit past the middle rounds up */
+    string_copy_cptr_sptr(test_str, "9007199254740993");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 9007199254740992.0);
+    string_copy_cptr_sptr(test_str, "9007199254740993.00000000000000000000000000000001");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 9007199254740994.0);
+    string_copy_cptr_sptr(test_str, "1.00000000000000011102230246251565404236316680908203125");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 1.0);
+    string_copy_cptr_sptr(test_str, "1.00000000000000011102230246251565404236316680908203126");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 1.0000000000000002);
+
+    /* the ends of the range */
+    string_copy_cptr_sptr(test_str, "1.7976931348623157e308");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 1.7976931348623157e308);
+    string_copy_cptr_sptr(test_str, "1.7976931348623159e308");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OVERFLOW && test_value == 1.7976931348623157e308);
+    string_copy_cptr_sptr(test_str, "3e-324");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == tiny);
+    string_copy_cptr_sptr(test_str, "-1e-400");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 0.0);
+    test_status = string_to_double(test_str, NULL);
+    assert(test_status == STRING_NUM_OK);
+    string_copy_cptr_sptr(test_str, "-Infinity");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value < -1.7976931348623157e308);
+    string_copy_cptr_sptr(test_str, "nan");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_OK && test_value != test_value);
+
+    /* malformed numbers */
+    string_copy_cptr_sptr(test_str, "1e");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "-.e1");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "1.5 ");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_INVALID);
+    string_copy_cptr_sptr(test_str, "1,5");
+    test_status = string_to_double(test_str, &test_value);
+    assert(test_status == STRING_NUM_INVALID);
+    test_status = string_to_double(NULL, &test_value);
+    assert(test_status == STRING_NUM_INVALID && test_value != test_value);
+    test_status = string_view_to_double(string_view_slice(string_view_from_cstr("2.5e"), 0, 3), &test_value);
+    assert(test_status == STRING_NUM_OK && test_value == 2.5);
+
+    /* the shortest form that reads back the same */
+    string_erase(test_str, 0, test_str->length);
+    bool_changed    =   string_append_double(test_str, 0.1);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_append_double_h(&test_str, -2.5);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_append_double(test_str, 1e21);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_append_double(test_str, 123456789012345680000.0);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_append_double(test_str, 1.5e-7);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_append_double(test_str, 0.000001);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed    =   string_append_double(test_str, tiny);
+    bool_changed2   =   string_insert(test_str, test_str->length, " ");
+    assert(bool_changed && bool_changed2);
+    bool_changed = string_append_double(test_str, -0.0);
+    assert(bool_changed);
+    assert(string_equal_cstring(test_str, "0.1 -2.5 1e+21 123456789012345680000 1.5e-7 0.000001 5e-324 -0"));
+
+    /* interned strings are immutable, however much room they have */
+    interned_str = string_intern_cstr("abc");
+    bool_changed    =   string_append_double(interned_str, 1.5);
+    bool_changed2   =   string_append_double_h(&interned_str, 1.5);
+    assert(!bool_changed && !bool_changed2);
+    interned_again = string_intern_cstr("abc");
+    assert(string_equal_cstring(interned_str, "abc") && interned_again == interned_str);
+    string_intern_cleanup();
+
+    for (idx = 0, test_value = 1.0 / 3.0; idx < 40; idx++, test_value *= -7.3)
+    {
+        double round_trip = 0.0;
+
+        string_erase(test_str, 0, test_str->length);
+        bool_changed    =   string_append_double(test_str, test_value);
+        test_status     =   string_to_double(test_str, &round_trip);
+        assert(bool_changed && test_status == STRING_NUM_OK && round_trip == test_value);
+    }
+
+    string_destroy(test_str);
+}
@@ -43,4 +43,49 @@ void test_string_set_range(void);
 
 void test_string_replace(void);
 
+void test_string_inline_storage(void);
+
+void test_string_reserve(void);
+
+void test_string_shrink_to_fit(void);
+
+void test_string_arena(void);
+
+void test_string_flat_init(void);
+
+void test_string_set_allocator(void);
+
+void test_string_intern(void);
+
+void test_string_set_copy_on_write(void);
+
+void test_string_view(void);
+
+void test_string_rope(void);
+
+void test_string_builder(void);
+
+void test_string_pattern(void);
+
+void test_string_multimatch(void);
+
+void test_string_replace_all(void);
+
+void test_string_replace_many(void);
+
+void test_string_splice(void);
+
+void test_string_case(void);
+
+void test_string_charset(void);
+
+void test_string_filter(void);
+
+void test_string_charset_span(void);
+void test_string_hash(void);
+void test_string_map(void);
+void test_string_compare(void);
+void test_string_to_int64(void);
+void test_string_double(void);
+
 #endif /* STRINGTEST_H_INCLUDED */
@@ -6,8 +6,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
+#include <limits.h>
+#include <stddef.h>
 #include "String.h"
+#include "StringPrivate.h"
+
+static double growth_factor = STRING_DEFAULT_GROWTH_FACTOR; /* see string_set_growth_factor() */
+static int bool_copy_on_write = 0; /* see string_set_copy_on_write() */
+
+/* A reference counted char array shared by the string objects that have the STRING_FLAG_SHARED flag set. */
+struct string_shared_buffer_t
+{
+    int ref_count;
+    int size; /* number of bytes in chars */
+    char chars[];
+};
 
 /**********************************************************************************
 *                                                                                 *
@@ -19,36 +32,393 @@
 
 
 
-/** \brief The string data type initializer.
+/** \brief Returns the number of bytes allocated for a string object with an inline buffer of the given size.
  *
- * \param None
- * \return string_t* A pointer to the newly allocated string object in memory.
+ * \param inline_capacity int The size of the string object's inline buffer.
+ * \return size_t The size of the string object's allocation.
  *
- * Initializes a new string object on the heap with an initially-sized internal char array of 200 chars.
- * The initializer function returns a pointer to the new object allocated.
  */
-string_t* string_init(void)
+size_t string_object_size(int inline_capacity)
 {
-    string_t* str               =   NULL;
-    char* under_lying_array     =   (char*)calloc(200, sizeof(char));
+    size_t object_size = offsetof(string_t, inline_buffer) + (size_t)inline_capacity;
+
+    return object_size > sizeof(string_t) ? object_size : sizeof(string_t);
+}
 
-    if (under_lying_array != NULL)
+/** \brief Returns the number of bytes a string object can use from its char_array onwards in a shared buffer.
+ *
+ * \param str const string_t* A pointer to a string object with the STRING_FLAG_SHARED flag set.
+ * \return int The capacity of the string object.
+ *
+ */
+static int string_shared_capacity(const string_t* str)
+{
+    return str->shared_buffer->size - (int)(str->char_array - str->shared_buffer->chars);
+}
+
+/** \brief Lets go of the characters of a string object, leaving it empty and stored inline.
+ *
+ * \param str string_t* A pointer to the string object.
+ * \return void Nothing.
+ *
+ * A shared buffer is only freed once the last string object referring to it lets go of it.
+ * Must not be called on arena string objects.
+ */
+static void string_release_chars(string_t* str)
+{
+    if (str->flags & STRING_FLAG_SHARED)
     {
-        str = (string_t*)calloc(1, sizeof(string_t));
+        if (STRING_ATOMIC_SUB(str->shared_buffer->ref_count, 1) == 0)
+            string_mem_free(str->shared_buffer, offsetof(string_shared_buffer_t, chars) + str->shared_buffer->size);
 
-        if (str != NULL)
+        str->shared_buffer      =   NULL;
+        str->flags              &=  ~STRING_FLAG_SHARED;
+    }
+    else if (str->char_array != str->inline_buffer)
+    {
+        string_mem_free(str->char_array, str->capacity);
+    }
+
+    str->char_array         =   str->inline_buffer;
+    str->capacity           =   str->inline_capacity;
+    str->length             =   0;
+    str->char_array[0]      =   '\0';
+}
+
+/** \brief Gives a string object that shares its characters with other string objects a private copy of them.
+ *
+ * \param str string_t* A pointer to a string object with the STRING_FLAG_SHARED flag set.
+ * \return int A Boolean value indicating whether or not the string object now owns its characters.
+ *
+ * A string object that is the only one left referring to its shared buffer simply keeps using it.
+ */
+static int string_unshare(string_t* str)
+{
+    char* private_array         =   str->inline_buffer;
+    int private_capacity        =   str->inline_capacity;
+    int bool_unshared           =   1;
+
+    if (STRING_ATOMIC_LOAD(str->shared_buffer->ref_count) > 1)
+    {
+        if (str->length + 1 > str->inline_capacity)
         {
-            str->char_array             =   under_lying_array;
-            str->capacity               =   200;
-            str->length                 =   0;
+            private_capacity    =   string_shared_capacity(str);
+            private_array       =   (char*)string_mem_alloc(private_capacity);
+        }
+
+        if (private_array != NULL)
+        {
+            memcpy(private_array, str->char_array, str->length + 1);
+
+            if (STRING_ATOMIC_SUB(str->shared_buffer->ref_count, 1) == 0) /* the other owners let go meanwhile */
+                string_mem_free(str->shared_buffer, offsetof(string_shared_buffer_t, chars) + str->shared_buffer->size);
+
+            str->shared_buffer      =   NULL;
+            str->flags              &=  ~STRING_FLAG_SHARED;
+            str->char_array         =   private_array;
+            str->capacity           =   private_capacity;
         }
         else
         {
-            free(under_lying_array);
+            bool_unshared = 0;
         }
     }
 
-    return str;
+    return bool_unshared;
+}
+
+/** \brief Prepares a string object for a change to its contents.
+ *
+ * \param str string_t* A pointer to the string object about to be changed.
+ * \return int A Boolean value indicating whether or not the string object may be changed.
+ *
+ * Every function that changes the characters or the storage of a string object calls this first.
+ * NULL pointers and immutable string objects--such as the ones returned by string_intern()--are refused.
+ * A string object sharing its characters with other string objects is given its own copy of them first,
+ * and the hash cached by string_hash() is dropped.
+ */
+static int string_begin_write(string_t* str)
+{
+    if (str == NULL || (str->flags & STRING_FLAG_IMMUTABLE))
+        return 0;
+
+    str->flags &= ~STRING_FLAG_HASHED; /* the cached hash is about to go stale */
+
+    if (str->flags & STRING_FLAG_SHARED)
+        return string_unshare(str);
+
+    return 1;
+}
+
+/** \brief Prepares a string object for having all of its contents replaced.
+ *
+ * \param str string_t* A pointer to the string object about to be overwritten.
+ * \return int A Boolean value indicating whether or not the string object may be changed.
+ *
+ * Like string_begin_write(), but a string object sharing its characters simply lets go of them instead of
+ * copying them, leaving it empty. Only call this once the caller is certain to overwrite the contents.
+ */
+static int string_begin_overwrite(string_t* str)
+{
+    if (str == NULL || (str->flags & STRING_FLAG_IMMUTABLE))
+        return 0;
+
+    str->flags &= ~STRING_FLAG_HASHED;
+
+    if ((str->flags & STRING_FLAG_SHARED) && STRING_ATOMIC_LOAD(str->shared_buffer->ref_count) > 1)
+        string_release_chars(str);
+
+    return 1;
+}
+
+/** \brief Makes a string object refer to the characters of another one from a given index to the end.
+ *
+ * \param dest string_t* A pointer to the string object that is to share the characters.
+ * \param source string_t* A pointer to the string object whose characters are shared.
+ * \param src_strt_idx int The index of the first character to share.
+ * \return int A Boolean value indicating whether or not the characters are now shared.
+ *
+ * Only heap char arrays are shared; inline and arena storage is not. The first time the characters of a
+ * string object are shared they are moved into a reference counted buffer, which is why source is not const.
+ */
+static int string_share_chars(string_t* dest, string_t* source, int src_strt_idx)
+{
+    string_shared_buffer_t* buffer = NULL;
+
+    if (dest == source || dest->arena != NULL || source->arena != NULL || (dest->flags & STRING_FLAG_IMMUTABLE))
+        return 0;
+
+    if (source->flags & STRING_FLAG_SHARED)
+    {
+        buffer = source->shared_buffer;
+    }
+    else if (source->char_array != source->inline_buffer)
+    {
+        buffer = (string_shared_buffer_t*)string_mem_alloc(offsetof(string_shared_buffer_t, chars) + source->capacity);
+
+        if (buffer != NULL)
+        {
+            buffer->ref_count   =   1;
+            buffer->size        =   source->capacity;
+            memcpy(buffer->chars, source->char_array, source->length + 1);
+            string_mem_free(source->char_array, source->capacity);
+
+            source->shared_buffer       =   buffer;
+            source->char_array          =   buffer->chars;
+            source->flags               |=  STRING_FLAG_SHARED;
+        }
+    }
+
+    if (buffer != NULL)
+    {
+        STRING_ATOMIC_ADD(buffer->ref_count, 1);
+        string_release_chars(dest);
+
+        dest->shared_buffer     =   buffer;
+        dest->char_array        =   source->char_array + src_strt_idx;
+        dest->length            =   source->length - src_strt_idx;
+        dest->capacity          =   string_shared_capacity(dest);
+        dest->flags             =   (dest->flags | STRING_FLAG_SHARED) & ~STRING_FLAG_HASHED;
+
+        if (src_strt_idx == 0 && (source->flags & STRING_FLAG_HASHED))
+        {
+            dest->hash      =   source->hash; /* a full copy has the same hash */
+            dest->flags     |=  STRING_FLAG_HASHED;
+        }
+    }
+
+    return buffer != NULL;
+}
+
+/** \brief Moves the internal char array of a string object into a block of the requested capacity.
+ *
+ * \param str string_t* A pointer to the string object to resize.
+ * \param new_capacity int The number of bytes the internal char array should be able to hold.
+ * \return int A Boolean value indicating whether or not the string object can now hold new_capacity bytes.
+ *
+ * Strings stored in the inline buffer are moved to the heap--or to their arena--when they outgrow it; strings
+ * already on the heap are simply reallocated. The contents--including the terminating null character--are preserved.
+ */
+static int string_set_capacity(string_t* str, int new_capacity)
+{
+    char* temp              =   NULL;
+    int bool_resized        =   0;
+    int length;
+
+    if (new_capacity <= str->capacity)
+    {
+        bool_resized = 1; /* nothing to do, the string can already hold new_capacity bytes */
+    }
+    else if (str->flags & STRING_FLAG_SHARED)
+    {
+        temp = (char*)string_mem_alloc(new_capacity); /* the shared buffer is left to its other owners */
+
+        if (temp != NULL)
+        {
+            memcpy(temp, str->char_array, str->length + 1);
+            length = str->length;
+            string_release_chars(str);
+            str->length             =   length;
+            str->char_array         =   temp;
+            str->capacity           =   new_capacity;
+            bool_resized            =   1;
+        }
+    }
+    else if (str->arena != NULL)
+    {
+        if (str->char_array == str->inline_buffer)
+        {
+            temp = (char*)string_arena_alloc(str->arena, new_capacity);
+            if (temp != NULL)
+                memcpy(temp, str->char_array, str->length + 1);
+        }
+        else
+        {
+            temp = (char*)string_arena_realloc(str->arena, str->char_array, str->capacity, new_capacity);
+        }
+
+        if (temp != NULL)
+        {
+            str->char_array         =   temp;
+            str->capacity           =   new_capacity;
+            bool_resized            =   1;
+        }
+    }
+    else if (str->char_array == str->inline_buffer)
+    {
+        temp = (char*)string_mem_alloc(new_capacity);
+
+        if (temp != NULL)
+        {
+            memcpy(temp, str->char_array, str->length + 1);
+            str->char_array         =   temp;
+            str->capacity           =   new_capacity;
+            bool_resized            =   1;
+        }
+    }
+    else
+    {
+        temp = (char*)string_mem_realloc(str->char_array, str->capacity, new_capacity);
+
+        if (temp != NULL)
+        {
+            str->char_array         =   temp;
+            str->capacity           =   new_capacity;
+            bool_resized            =   1;
+        }
+    }
+
+    return bool_resized;
+}
+
+/** \brief Computes the capacity a string object should grow to in order to hold min_capacity bytes.
+ *
+ * \param str const string_t* A pointer to the string object to grow.
+ * \param min_capacity int The number of bytes--including the terminating null character--the string must hold.
+ * \return int The new capacity: the current capacity times the growth factor, but at least min_capacity.
+ *
+ */
+static int string_next_capacity(const string_t* str, int min_capacity)
+{
+    double grown_capacity;
+    int new_capacity;
+
+    grown_capacity = (double)str->capacity * growth_factor;
+    if (grown_capacity > (double)INT_MAX)
+        new_capacity = INT_MAX;
+    else
+        new_capacity = (int)grown_capacity;
+
+    if (new_capacity < min_capacity)
+        new_capacity = min_capacity;
+
+    return new_capacity;
+}
+
+/** \brief Makes sure a string object can hold at least min_capacity bytes, growing it geometrically if it cannot.
+ *
+ * \param str string_t* A pointer to the string object to grow.
+ * \param min_capacity int The number of bytes--including the terminating null character--the string must hold.
+ * \return int A Boolean value indicating whether or not the string object can now hold min_capacity bytes.
+ *
+ * This is the growth policy shared by every mutating function: the capacity is multiplied by the growth factor
+ * (see string_set_growth_factor()) so that repeated appends cost amortized O(1) per character.
+ */
+static int string_grow(string_t* str, int min_capacity)
+{
+    if (min_capacity <= str->capacity)
+        return 1;
+
+    return string_set_capacity(str, string_next_capacity(str, min_capacity));
+}
+
+/** \brief Makes sure the string object behind a handle can hold at least min_capacity bytes.
+ *
+ * \param str string_t** A pointer to the handle of the string object to grow.
+ * \param min_capacity int The number of bytes--including the terminating null character--the string must hold.
+ * \param bool_geometric int A Boolean value; when true the capacity grows by the growth factor, otherwise
+ * to exactly min_capacity.
+ * \return int A Boolean value indicating whether or not the string object can now hold min_capacity bytes.
+ *
+ * A heap string object whose characters are stored inside the object is grown by reallocating the whole object,
+ * keeping the header and the characters in a single allocation, and *str is updated to its new address.
+ * Other string objects are grown in place.
+ */
+static int string_grow_h(string_t** str, int min_capacity, int bool_geometric)
+{
+    string_t* temp          =   NULL;
+    int bool_resized        =   0;
+    int new_capacity        =   min_capacity;
+
+    if (!string_begin_write(*str))
+    {
+        bool_resized = 0; /* the string object may not be changed */
+    }
+    else if (min_capacity <= (*str)->capacity)
+    {
+        bool_resized = 1;
+    }
+    else if ((*str)->arena != NULL || (*str)->char_array != (*str)->inline_buffer)
+    {
+        if (bool_geometric)
+            bool_resized = string_grow(*str, min_capacity);
+        else
+            bool_resized = string_set_capacity(*str, min_capacity);
+    }
+    else
+    {
+        if (bool_geometric)
+            new_capacity = string_next_capacity(*str, min_capacity);
+
+        if (new_capacity <= INT_MAX - (int)sizeof(string_t))
+            temp = (string_t*)string_mem_realloc(*str, string_object_size((*str)->inline_capacity),
+                                                 string_object_size(new_capacity));
+
+        if (temp != NULL)
+        {
+            temp->char_array        =   temp->inline_buffer;
+            temp->capacity          =   new_capacity;
+            temp->inline_capacity   =   new_capacity;
+            *str                    =   temp;
+            bool_resized            =   1;
+        }
+    }
+
+    return bool_resized;
+}
+
+/** \brief The string data type initializer.
+ *
+ * \param None
+ * \return string_t* A pointer to the newly allocated string object in memory.
+ *
+ * Initializes a new string object on the heap whose characters are stored in the object's inline buffer
+ * of STRING_INLINE_CAPACITY chars, so creating a short string takes a single allocation.
+ * The initializer function returns a pointer to the new object allocated.
+ */
+string_t* string_init(void)
+{
+    return string_cust_init(STRING_INLINE_CAPACITY);
 }
 
 /** \brief Custom initializer for the string data type.
@@ -57,6 +427,7 @@ string_t* string_init(void)
  * \return string_t* A pointer to the new string object.
  *
  * Initializes a new string object to specified initial capacity and returns a pointer to it.
+ * Capacities of up to STRING_INLINE_CAPACITY chars are served by the object's inline buffer.
  */
 string_t* string_cust_init(int initial_size)
 {
@@ -65,21 +436,33 @@ string_t* string_cust_init(int initial_size)
 
     if (initial_size > 0)
     {
-        under_lying_array = (char*)calloc(initial_size, sizeof(char));
+        str = (string_t*)string_mem_calloc(string_object_size(STRING_INLINE_CAPACITY));
 
-        if (under_lying_array != NULL)
+        if (str != NULL)
         {
-            str = (string_t*)calloc(1, sizeof(string_t));
+            str->inline_capacity = STRING_INLINE_CAPACITY;
 
-            if (str != NULL)
+            if (initial_size <= STRING_INLINE_CAPACITY)
             {
-                str->char_array     =   under_lying_array;
-                str->capacity       =   initial_size;
+                str->char_array     =   str->inline_buffer;
+                str->capacity       =   STRING_INLINE_CAPACITY;
                 str->length         =   0;
             }
             else
             {
-                free(under_lying_array);
+                under_lying_array = (char*)string_mem_calloc(initial_size);
+
+                if (under_lying_array != NULL)
+                {
+                    str->char_array     =   under_lying_array;
+                    str->capacity       =   initial_size;
+                    str->length         =   0;
+                }
+                else
+                {
+                    string_mem_free(str, string_object_size(STRING_INLINE_CAPACITY));
+                    str = NULL;
+                }
             }
         }
     }
@@ -87,65 +470,216 @@ string_t* string_cust_init(int initial_size)
     return str;
 }
 
+/** \brief Initializer for a string object stored in a single allocation.
+ *
+ * \param initial_size int Initial capacity of the string.
+ * \return string_t* A pointer to the new string object.
+ *
+ * The characters are stored directly after the string object's fields--in an inline buffer of initial_size
+ * bytes--so reading them costs no extra pointer chase and the object is freed in one call.
+ * The functions taking a string_t** handle (string_concat_h() etc.) keep it in one allocation as it grows
+ * by reallocating the whole object; the other functions move the characters out to a separate array instead.
+ */
+string_t* string_flat_init(int initial_size)
+{
+    string_t* str = NULL;
+
+    if (initial_size > 0 && initial_size <= INT_MAX - (int)sizeof(string_t))
+    {
+        if (initial_size < STRING_INLINE_CAPACITY)
+            initial_size = STRING_INLINE_CAPACITY;
+
+        str = (string_t*)string_mem_calloc(string_object_size(initial_size));
+
+        if (str != NULL)
+        {
+            str->char_array         =   str->inline_buffer;
+            str->capacity           =   initial_size;
+            str->inline_capacity    =   initial_size;
+            str->length             =   0;
+        }
+    }
+
+    return str;
+}
+
 /** \brief Free the memory allocated for a string.
  *
  * \param str string_t* A pointer to the string to cleanup.
  * \return void Nothing
  *
  * Deallocates the memory allocated for the string object pointed to by 'str'.
+ * String objects created in an arena are left alone; their memory is released with the arena.
+ * Interned string objects are left alone as well; they belong to the intern table.
  */
 void string_destroy(string_t* str)
 {
-    if (str != NULL)
+    if (str != NULL && str->arena == NULL && !(str->flags & STRING_FLAG_INTERNED))
     {
-        free(str->char_array);
-        free(str);
+        string_release_chars(str);
+        string_mem_free(str, string_object_size(str->inline_capacity));
     }
 }
 
-/** \brief Compares two string objects to see if they contain identical strings.
+/** \brief Sets the factor by which the internal char arrays of string objects grow when they run out of space.
  *
- * \param str1 const string_t* The first string object for comparison.
- * \param str2 const string_t* The second string object for comparison.
- * \return int A Boolean value indicating equality or a lack of it.
+ * \param factor double The new growth factor. Values below 1.1 are raised to 1.1.
+ * \return void Nothing.
  *
- * Compares two string objects to see if they contain identical strings
- * and returns a Boolean value indicating the result.
+ * The default is STRING_DEFAULT_GROWTH_FACTOR. Larger factors trade memory for fewer reallocations.
  */
-int string_equal(const string_t* str1, const string_t* str2)
+void string_set_growth_factor(double factor)
+{
+    if (factor < 1.1)
+        factor = 1.1;
+
+    growth_factor = factor;
+}
+
+/** \brief Turns copy-on-write sharing of char arrays on or off.
+ *
+ * \param enabled int A Boolean value; true to let copies share char arrays, false to always copy characters.
+ * \return void Nothing.
+ *
+ * While enabled, string_copy_sptr() and string_get_slice() make the new copy refer to the source's heap char
+ * array instead of copying it, so fanning out copies of a large string takes constant time and memory. The
+ * first function to change either string object gives it a private copy. Copying a string object then updates
+ * its bookkeeping, so the source must not be used by another thread during the copy. Off by default.
+ */
+void string_set_copy_on_write(int enabled)
+{
+    bool_copy_on_write = enabled ? 1 : 0;
+}
+
+/** \brief Pre-sizes the internal char array of a string object.
+ *
+ * \param str string_t* A pointer to the string object.
+ * \param num_chars int The number of characters--excluding the terminating null character--to make room for.
+ * \return int A Boolean value indicating whether or not the string object can now hold num_chars characters.
+ *
+ * Reserving room up front lets a series of appends run without any reallocation. The contents are not changed.
+ */
+int string_reserve(string_t* str, int num_chars)
+{
+    int bool_reserved = 0;
+
+    if (string_begin_write(str) && num_chars >= 0 && num_chars < INT_MAX)
+        bool_reserved = string_set_capacity(str, num_chars + 1);
+
+    return bool_reserved;
+}
+
+/** \brief Pre-sizes a string object through its handle.
+ *
+ * \param str string_t** A pointer to the handle of the string object.
+ * \param num_chars int The number of characters--excluding the terminating null character--to make room for.
+ * \return int A Boolean value indicating whether or not the string object can now hold num_chars characters.
+ *
+ * Like string_reserve(), but a string object kept in a single allocation is reallocated as a whole
+ * and *str is updated to its new address--any other pointers to the object become invalid.
+ */
+int string_reserve_h(string_t** str, int num_chars)
+{
+    int bool_reserved = 0;
+
+    if (str != NULL && string_begin_write(*str) && num_chars >= 0 && num_chars < INT_MAX)
+        bool_reserved = string_grow_h(str, num_chars + 1, 0);
+
+    return bool_reserved;
+}
+
+/** \brief Releases the unused capacity of a string object.
+ *
+ * \param str string_t* A pointer to the string object.
+ * \return void Nothing.
+ *
+ * Strings short enough to fit the inline buffer are moved back into it and their heap array is freed.
+ * Longer strings have their heap array reallocated to exactly length + 1 bytes. Arena memory is only
+ * reclaimed when the arena is reset, so long strings in an arena are left as they are, and so are
+ * string objects that still refer to a shared buffer.
+ */
+void string_shrink_to_fit(string_t* str)
 {
-    const char* str1_cptr;
-    const char* str2_cptr;
-    int return_val = 0;
+    char* temp = NULL;
 
-    if (str1 != NULL && str2 != NULL)
+    if (string_begin_write(str) && str->char_array != str->inline_buffer && !(str->flags & STRING_FLAG_SHARED))
     {
-        if (str1->length == str2->length)
+        if (str->length < str->inline_capacity)
+        {
+            memcpy(str->inline_buffer, str->char_array, str->length + 1);
+            if (str->arena == NULL)
+                string_mem_free(str->char_array, str->capacity);
+            str->char_array     =   str->inline_buffer;
+            str->capacity       =   str->inline_capacity;
+        }
+        else if (str->length + 1 < str->capacity && str->arena == NULL)
         {
-            return_val = 1;
+            temp = (char*)string_mem_realloc(str->char_array, str->capacity, str->length + 1);
 
-            for (str1_cptr = str1->char_array, str2_cptr = str2->char_array;
-                 *str1_cptr != '\0' && *str2_cptr != '\0'; str1_cptr++, str2_cptr++)
+            if (temp != NULL)
             {
-                if (*str1_cptr != *str2_cptr)
-                    return_val = 0; /* strings are not equal */
+                str->char_array     =   temp;
+                str->capacity       =   str->length + 1;
             }
         }
-        else
-        {
-            return_val = 0; /* strings of different lengths are never equal */
-        }
-    }
-    else if (str1 == NULL && str2 == NULL)
-    {
-        return_val = 1; /* NULL = NULL */
-    }
-    else
-    {
-        return_val = 0; /* not equal */
     }
+}
+
+/** \brief Compares two string objects to see if they contain identical strings.
+ *
+ * \param str1 const string_t* The first string object for comparison.
+ * \param str2 const string_t* The second string object for comparison.
+ * \return int A Boolean value indicating equality or a lack of it. Two NULL pointers are equal.
+ *
+ * Compares two string objects to see if they contain identical strings
+ * and returns a Boolean value indicating the result. Strings of different lengths or with different cached hashes
+ * are told apart without reading their characters, and the rest are compared with memcmp(), which stops at the
+ * first difference. Embedded null characters are compared like any other.
+ */
+int string_equal(const string_t* str1, const string_t* str2)
+{
+    if (str1 == NULL || str2 == NULL)
+        return str1 == str2;
+
+    if (str1->length != str2->length)
+        return 0;
+
+    if ((str1->flags & str2->flags & STRING_FLAG_HASHED) && str1->hash != str2->hash)
+        return 0;
 
-    return return_val;
+    /* the same object, or copies sharing one char array */
+    if (str1->char_array == str2->char_array)
+        return 1;
+
+    return memcmp(str1->char_array, str2->char_array, str1->length) == 0;
+}
+
+/** \brief Compares two string objects in lexicographical order.
+ *
+ * \param str1 const string_t* The first string object for comparison.
+ * \param str2 const string_t* The second string object for comparison.
+ * \return int A value less than, equal to or greater than 0 as str1 sorts before, the same as or after str2.
+ *
+ * Binary safe: bytes compare as unsigned values, embedded null characters included. A NULL pointer sorts before
+ * every string object. See string_view_compare().
+ */
+int string_compare(const string_t* str1, const string_t* str2)
+{
+    return string_view_compare(string_view_from_string(str1), string_view_from_string(str2));
+}
+
+/** \brief Compares a string object and a standard C string in lexicographical order.
+ *
+ * \param str1 const string_t* The string object.
+ * \param str2 const char* The C string.
+ * \return int A value less than, equal to or greater than 0 as str1 sorts before, the same as or after str2.
+ *
+ * A string object with an embedded null character sorts after a C string made of the characters before it.
+ * NULL pointers sort first. See string_view_compare().
+ */
+int string_compare_cstr(const string_t* str1, const char* str2)
+{
+    return string_view_compare(string_view_from_string(str1), string_view_from_cstr(str2));
 }
 
 /** \brief Copies the contents of one string object to another.
@@ -154,43 +688,50 @@ int string_equal(const string_t* str1, const string_t* str2)
  * \param source const string_t* The string object to copy from.
  * \return void Nothing.
  *
+ * With copy-on-write enabled (see string_set_copy_on_write()) the two string objects share a heap char array
+ * until one of them is changed.
  */
-void string_copy_sptr(string_t* dest, const string_t* source) /* add dynamic memory allocation feature here */
+void string_copy_sptr(string_t* dest, const string_t* source)
 {
-    char* dest_cptr;
-    const char* source_cptr;
-    char* temp = NULL;
-
-    if (dest != NULL && source != NULL)
+    if (dest != NULL && source != NULL && dest != source)
     {
         if (source->length > 0)
         {
-            if (dest->capacity < source->length + 1)
+            if (!bool_copy_on_write || !string_share_chars(dest, (string_t*)source, 0))
             {
-                temp = (char*)realloc(dest->char_array, source->length + 51);
-
-                if (temp != NULL)
+                if (string_begin_overwrite(dest))
                 {
-                    dest->char_array        =       temp;
-                    dest->capacity          =       source->length + 51;
-                }
-            }
+                    string_grow(dest, source->length + 1);
 
-            if (dest->capacity >= source->length + 1)
-            {
-                dest->length = 0;
-                for (source_cptr = source->char_array, dest_cptr = dest->char_array; *source_cptr != '\0';
-                    source_cptr++, dest_cptr++)
-                {
-                    *dest_cptr = *source_cptr;
-                    dest->length++;
+                    if (dest->capacity >= source->length + 1)
+                    {
+                        memcpy(dest->char_array, source->char_array, source->length + 1); /* copy the '\0' too */
+                        dest->length = source->length;
+                    }
                 }
-                *dest_cptr = *source_cptr; /* copy the '\0' */
             }
         }
     }
 }
 
+/** \brief Copies the contents of one string object to another through the destination's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object to copy to.
+ * \param source const string_t* The string object to copy from.
+ * \return void Nothing.
+ *
+ * Like string_copy_sptr(), but a string object kept in a single allocation is grown as a whole and *dest is
+ * updated to its new address.
+ */
+void string_copy_sptr_h(string_t** dest, const string_t* source)
+{
+    if (dest != NULL && *dest != NULL && source != NULL && *dest != source)
+    {
+        string_grow_h(dest, source->length + 1, 1);
+        string_copy_sptr(*dest, source);
+    }
+}
+
 /** \brief Copies the contents of a standard C string, a char array, to a string object.
  *
  * \param dest string_t* A pointer to the string object to copy to.
@@ -200,179 +741,311 @@ void string_copy_sptr(string_t* dest, const string_t* source) /* add dynamic mem
  */
 void string_copy_cptr_sptr(string_t* dest, const char* source)
 {
-    int source_pos;
-    char* temp = NULL;
+    int source_len;
 
-    if (dest != NULL && source != NULL)
+    if (string_begin_write(dest) && source != NULL)
     {
-        if (strlen(source) > 0)
-        {
-            if (dest->capacity < (int)(strlen(source)) + 1)
-            {
-                /* allocate space for the new string plus a little more */
-                temp = (char*)realloc(dest->char_array, strlen(source) + 51);
+        source_len = (int)strlen(source);
 
-                if (temp != NULL)
-                {
-                    dest->char_array        =       temp;
-                    dest->capacity          =       strlen(source) + 51;
-                }
-            }
+        if (source_len > 0)
+        {
+            string_grow(dest, source_len + 1);
 
-            if (dest->capacity >= (int)(strlen(source)) + 1)
+            if (dest->capacity >= source_len + 1)
             {
-                dest->length = 0;
-                for (source_pos = 0; source_pos < (int)(strlen(source)); source_pos++)
-                {
-                    dest->char_array[source_pos] = source[source_pos];
-                    dest->length++;
-                }
-
-                dest->char_array[source_pos + 1] = '\0'; /* mark the end of the string with a null character */
+                memmove(dest->char_array, source, source_len + 1); /* source may lie in dest's own chars */
+                dest->length = source_len;
             }
         }
     }
 }
 
+/** \brief Copies a standard C string to a string object through the string object's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object to copy to.
+ * \param source const char* A pointer the base of a char array to copy from.
+ * \return void Nothing.
+ *
+ * Like string_copy_cptr_sptr(), but a string object kept in a single allocation is grown as a whole and *dest
+ * is updated to its new address.
+ */
+void string_copy_cptr_sptr_h(string_t** dest, const char* source)
+{
+    if (dest != NULL && *dest != NULL && source != NULL)
+    {
+        /* a C string taken from the object's own characters already fits and must not be moved from under us */
+        if (source < (*dest)->char_array || source >= (*dest)->char_array + (*dest)->capacity)
+            string_grow_h(dest, (int)strlen(source) + 1, 1);
+
+        string_copy_cptr_sptr(*dest, source);
+    }
+}
+
 /** \brief Concatenates the contents of one string object onto another.
  *
  * \param str1 string_t* A pointer to the first string object.
  * \param str2 const string_t* A pointer to the second string object.
  * \return void Nothing.
  *
- * Concatenates the contents of str2 onto the end of str1's contents.
+ * Concatenates the contents of str2 onto the end of str1's contents.
+ */
+void string_concat(string_t* str1, const string_t* str2)
+{
+    int str2_length;
+
+    if (string_begin_write(str1) && str2 != NULL)
+    {
+        str2_length = str2->length; /* str1 and str2 may be the same string object */
+
+        if (str2_length > 0)
+        {
+            string_grow(str1, str1->length + str2_length + 1); /* + 1 for the '\0' character */
+
+            if (str1->capacity >= str1->length + str2_length + 1)
+            {
+                memmove(str1->char_array + str1->length, str2->char_array, str2_length);
+                str1->length                        +=      str2_length;
+                str1->char_array[str1->length]      =       '\0';
+            }
+        }
+    }
+}
+
+/** \brief Concatenates the contents of one string object onto another through the first one's handle.
+ *
+ * \param str1 string_t** A pointer to the handle of the first string object.
+ * \param str2 const string_t* A pointer to the second string object.
+ * \return void Nothing.
+ *
+ * Like string_concat(), but a string object kept in a single allocation is grown as a whole and *str1 is
+ * updated to its new address.
+ */
+void string_concat_h(string_t** str1, const string_t* str2)
+{
+    int bool_self_concat;
+
+    if (str1 != NULL && *str1 != NULL && str2 != NULL)
+    {
+        bool_self_concat = (*str1 == str2);
+        string_grow_h(str1, (*str1)->length + str2->length + 1, 1);
+        string_concat(*str1, bool_self_concat ? *str1 : str2);
+    }
+}
+
+/** \brief Converts all alphabetical characters in the string to lowercase.
+ *
+ * \param str string_t* The string object to convert.
+ * \return void Nothing.
+ *
+ * Only ASCII letters are converted. The whole length of the string is converted many characters at a time, so
+ * characters after an embedded null character are converted too.
+ */
+void string_tolower(string_t* str)
+{
+    if (string_begin_write(str))
+        string_case_map(str->char_array, str->char_array, str->length, 0);
+}
+
+/** \brief Converts all lowercase characters in the string to uppercase.
+ *
+ * \param str string_t* The string to convert.
+ * \return void Nothing.
+ *
+ * Only ASCII letters are converted. See string_tolower().
+ */
+void string_toupper(string_t* str)
+{
+    if (string_begin_write(str))
+        string_case_map(str->char_array, str->char_array, str->length, 1);
+}
+
+/** \brief Copies a string object into another one with the case of its letters converted.
+ *
+ * \param dest string_t* A pointer to the string object to copy to--may be source itself.
+ * \param source const string_t* A pointer to the string object to copy.
+ * \param bool_upper int A Boolean value; when true lowercase letters are made uppercase, otherwise the reverse.
+ * \return int A Boolean value indicating whether or not the converted copy was made.
+ *
+ * The characters are converted as they are copied, so they are only read and written once.
+ */
+static int string_case_copy(string_t* dest, const string_t* source, int bool_upper)
+{
+    int length;
+
+    if (dest == NULL || source == NULL)
+        return 0;
+
+    if (dest == source)
+    {
+        if (!string_begin_write(dest))
+            return 0;
+    }
+    else
+    {
+        length = source->length; /* dest may share source's characters until it lets go of them */
+
+        if (!string_begin_overwrite(dest) || !string_grow(dest, length + 1))
+            return 0;
+
+        dest->char_array[length]    =   '\0';
+        dest->length                =   length;
+    }
+
+    string_case_map(dest->char_array, source->char_array, source->length, bool_upper);
+
+    return 1;
+}
+
+/** \brief Copies a string object into another one with its letters converted to lowercase.
+ *
+ * \param dest string_t* A pointer to the string object to copy to--may be source itself.
+ * \param source const string_t* A pointer to the string object to copy.
+ * \return int A Boolean value indicating whether or not the converted copy was made.
+ *
+ * Leaves source unchanged, unlike string_tolower(). Only ASCII letters are converted.
+ */
+int string_tolower_copy(string_t* dest, const string_t* source)
+{
+    return string_case_copy(dest, source, 0);
+}
+
+/** \brief Copies a string object into another one with its letters converted to uppercase.
+ *
+ * \param dest string_t* A pointer to the string object to copy to--may be source itself.
+ * \param source const string_t* A pointer to the string object to copy.
+ * \return int A Boolean value indicating whether or not the converted copy was made.
+ *
+ * Leaves source unchanged, unlike string_toupper(). Only ASCII letters are converted.
+ */
+int string_toupper_copy(string_t* dest, const string_t* source)
+{
+    return string_case_copy(dest, source, 1);
+}
+
+/** \brief Removes all the of the non-alphabetical characters in a string.
+ *
+ * \param str string_t* String to remove the undesired characters from.
+ * \return void Nothing.
+ *
+ * See string_filter().
+ */
+void string_remove_nonalpha(string_t* str)
+{
+    string_filter(str, string_charset_class(STRING_CLASS_ALPHA), 1);
+}
+
+/** \brief Keeps only the characters of the string object that are--or are not--in a character set.
+ *
+ * \param str string_t* A pointer to the string object to filter.
+ * \param set const string_charset_t* A pointer to the set, such as one returned by string_charset_class().
+ * \param bool_keep int A Boolean value; when true the members of the set are kept and all other characters
+ * removed, otherwise the members are removed.
+ * \return int The number of characters removed.
+ *
+ * The kept characters are compacted towards the front in a single pass, so filtering takes O(n) time however many
+ * characters are removed--see string_charset_compact(). The string object is never reallocated.
  */
-void string_concat(string_t* str1, const string_t* str2)
+int string_filter(string_t* str, const string_charset_t* set, int bool_keep)
 {
-    int str1_pos, str2_pos;
-    char* temp = NULL;
+    int kept;
+    int num_removed = 0;
 
-    if (str1 != NULL && str2 != NULL)
+    if (set != NULL && string_begin_write(str))
     {
-        if (str2->length > 0)
-        {
-            if (str1->capacity < str1->length + str2->length + 2) /* + 2 for the '\0' characters */
-            {
-                temp = realloc(str1->char_array, str1->length + str2->length + 52);
-
-                if (temp != NULL)
-                {
-                    str1->char_array        =       temp;
-                    str1->capacity          =       str1->length + str2->length + 52;
-                }
-            }
-
-            if (str1->capacity >= str1->length + str2->length + 2)
-            {
-                for (str1_pos = str1->length, str2_pos = 0; str2_pos < str2->length; str1_pos++, str2_pos++)
-                {
-                    str1->char_array[str1_pos] = str2->char_array[str2_pos];
-                    str1->length++;
-                }
-
-                str1->char_array[str1_pos] = str2->char_array[str2_pos]; /* copy null char */
-            }
-        }
+        kept                        =   string_charset_compact(set, str->char_array, str->length, bool_keep);
+        num_removed                 =   str->length - kept;
+        str->length                 =   kept;
+        str->char_array[kept]       =   '\0';
     }
+
+    return num_removed;
 }
 
-/** \brief Converts all alphabetical characters in the string to lowercase.
+/** \brief Removes the characters in a set from both ends of the string object.
  *
- * \param str string_t* The string object to convert.
- * \return void Nothing.
+ * \param str string_t* A pointer to the string object to trim.
+ * \param set const string_charset_t* A pointer to the set of characters to remove, or NULL for white space.
+ * \return int The number of characters removed.
  *
+ * The ends are found many characters at a time--see string_charset_scan()--and the string object is never
+ * reallocated.
  */
-void string_tolower(string_t* str)
+int string_trim(string_t* str, const string_charset_t* set)
 {
-    char* str_cptr;
+    int num_removed = string_rtrim(str, set);
 
-    if (str != NULL)
-    {
-        if (str->length > 0)
-        {
-            for (str_cptr = str->char_array; *str_cptr != '\0'; str_cptr++)
-            {
-                if (*str_cptr >= 'A' && *str_cptr <= 'Z')
-                    *str_cptr += 32;
-            }
-        }
-    }
+    return num_removed + string_ltrim(str, set);
 }
 
-/** \brief Converts all lowercase characters in the string to uppercase.
+/** \brief Removes the characters in a set from the beginning of the string object.
  *
- * \param str string_t* The string to convert.
- * \return void Nothing.
+ * \param str string_t* A pointer to the string object to trim.
+ * \param set const string_charset_t* A pointer to the set of characters to remove, or NULL for white space.
+ * \return int The number of characters removed.
  *
  */
-void string_toupper(string_t* str)
+int string_ltrim(string_t* str, const string_charset_t* set)
 {
-    char* str_cptr;
+    int num_removed = 0;
 
-    if (str != NULL)
+    if (set == NULL)
+        set = string_charset_class(STRING_CLASS_SPACE);
+
+    if (str != NULL && str->length > 0)
+        num_removed = string_charset_scan(set, str->char_array, str->length, 1);
+
+    if (num_removed > 0)
     {
-        if (str->length > 0)
+        if (string_begin_write(str))
         {
-            for (str_cptr = str->char_array; *str_cptr != '\0'; str_cptr++)
-            {
-                if (*str_cptr >= 'a' && *str_cptr <= 'z')
-                    *str_cptr -= 32;
-            }
+            memmove(str->char_array, str->char_array + num_removed, str->length - num_removed + 1);
+            str->length -= num_removed;
+        }
+        else
+        {
+            num_removed = 0;
         }
     }
+
+    return num_removed;
 }
 
-/** \brief Removes all the of the non-alphabetical characters in a string.
+/** \brief Removes the characters in a set from the end of the string object.
  *
- * \param str string_t* String to remove the undesired characters from.
- * \return void Nothing.
+ * \param str string_t* A pointer to the string object to trim.
+ * \param set const string_charset_t* A pointer to the set of characters to remove, or NULL for white space.
+ * \return int The number of characters removed.
  *
  */
-void string_remove_nonalpha(string_t* str)
+int string_rtrim(string_t* str, const string_charset_t* set)
 {
-    int str_inner_pos, str_outer_pos;
+    int num_removed = 0;
 
-    if (str != NULL)
+    if (set == NULL)
+        set = string_charset_class(STRING_CLASS_SPACE);
+
+    if (str != NULL && str->length > 0)
+        num_removed = str->length - 1 - string_charset_scan_reverse(set, str->char_array, str->length, 1);
+
+    if (num_removed > 0)
     {
-        if (str->length > 0)
+        if (string_begin_write(str))
         {
-            for (str_outer_pos = 0; str_outer_pos < str->length; str_outer_pos++)
-            {
-                if (!((str->char_array)[str_outer_pos] >= 'a' && (str->char_array)[str_outer_pos] <= 'z')
-                    && !((str->char_array)[str_outer_pos] >= 'A' && (str->char_array)[str_outer_pos] <= 'Z'))
-                {
-                    for (str_inner_pos = str_outer_pos; str_inner_pos < str->length; str_inner_pos++)
-                        (str->char_array)[str_inner_pos] = (str->char_array)[str_inner_pos + 1];
-                    str->length--;
-                    str_outer_pos--; /* yucky, but otherwise the outer loop will skip one char. */
-                }
-            }
+            str->length                         -=  num_removed;
+            str->char_array[str->length]        =   '\0';
+        }
+        else
+        {
+            num_removed = 0;
         }
     }
 
+    return num_removed;
 }
 
 int string_isalpha(const string_t* str)
 {
-    const char* str_cptr;
-    int return_val = 1;
-
-    if (str != NULL)
-    {
-        if (str->length > 0)
-        {
-            for (str_cptr = str->char_array; *str_cptr != '\0'; str_cptr++)
-            {
-                if (!(*str_cptr >= 'a' && *str_cptr <= 'z') && !(*str_cptr >= 'A' && *str_cptr <= 'Z'))
-                {
-                    return_val = 0; /* str is not purely alphabetical. */
-                    break;
-                }
-            }
-        }
-    }
-
-    return return_val;
+    return string_view_isalpha(string_view_from_string(str));
 }
 
 /** \brief Tests whether the string object contains strictly alphanumeric characters.
@@ -383,34 +1056,7 @@ int string_isalpha(const string_t* str)
  */
 int string_isalphanum(const string_t* str)
 {
-    const char* str_cptr;
-    int return_val = 1;
-
-    if (str != NULL)
-    {
-        if (str->length > 0)
-        {
-            for (str_cptr = str->char_array; *str_cptr != '\0'; str_cptr++)
-            {
-                if (!(*str_cptr >= 'a' && *str_cptr <= 'z') && !(*str_cptr >= 'A' && *str_cptr <= 'Z')
-                    && !(*str_cptr >= '0' && *str_cptr <= '9'))
-                {
-                        return_val = 0; /* str is not alphanumeric. */
-                        break;
-                }
-            }
-        }
-        else
-        {
-            return_val = 0; /* A 0-length string is not alphanumeric. */
-        }
-    }
-    else
-    {
-        return_val = 0; /* A NULL string is not strictly alphanumeric. */
-    }
-
-    return return_val;
+    return string_view_isalphanum(string_view_from_string(str));
 }
 
 /** \brief Returns a Boolean value indicating whether or not the string is strictly non-alphabetical.
@@ -422,25 +1068,7 @@ int string_isalphanum(const string_t* str)
  */
 int string_isnonalpha(const string_t* str)
 {
-    const char* str_cptr;
-    int return_val = 1;
-
-    if (str != NULL)
-    {
-        if (str->length > 0)
-        {
-            for (str_cptr = str->char_array; *str_cptr != '\0'; str_cptr++)
-            {
-                if ((*str_cptr >= 'a' && *str_cptr <= 'z') || (*str_cptr >= 'A' && *str_cptr <= 'Z'))
-                {
-                    return_val = 0; /* str is NOT non-alphabetical--it's alphabetical */
-                    break;
-                }
-            }
-        }
-    }
-
-    return return_val; /* return true; str is non-alphabetical */
+    return string_view_isnonalpha(string_view_from_string(str));
 }
 
 /** \brief Returns the integer corresponding to the specified string form of the integer.
@@ -448,47 +1076,64 @@ int string_isnonalpha(const string_t* str)
  * \param str string_t* A pointer to the string object to convert.
  * \return int The signed integer equivalent to the string object.
  *
+ * See string_view_toint() for the error codes and string_to_int64() for a conversion that reports errors apart.
  */
 int string_toint(const string_t* str)
 {
-    int highest_power;
-    int return_val;
-    const char* str_cptr;
+    return string_view_toint(string_view_from_string(str));
+}
 
-    if (str != NULL)
-    {
-        if (str->length > 0)
-        {
-            str_cptr = str->char_array;
+/** \brief Appends the shortest decimal form of a double to the string object.
+ *
+ * \param str string_t* A pointer to the string object to append to.
+ * \param value double The value to append.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the number was appended.
+ *
+ * Appends the fewest digits that string_to_double() converts back to exactly the same double, formatted straight
+ * into the string's characters: "0.1", "-2.5", "100", "1e+21", "5e-324", "inf", "nan". The decimal point is always
+ * '.', whatever the locale.
+ */
+int string_append_double(string_t* str, double value)
+{
+    int bool_appended = 0;
 
-            if (string_is_int(str))
-            {
-                return_val = 0;
-                highest_power = strlen(str->char_array) - 1;
+    if (str == NULL || (str->flags & STRING_FLAG_IMMUTABLE) || str->length > INT_MAX - 1 - STRING_DOUBLE_MAX_CHARS)
+        return 0;
 
-                while (*str_cptr != '\0')
-                {
-                    return_val += (*str_cptr - '0') * (int)pow(10, highest_power);
-                    str_cptr++;
-                    highest_power--;
-                }
-            }
-            else
-            {
-                return_val = -3; /* "str" is not a valid integer. */
-            }
-        }
-        else
-        {
-            return_val = -2; /* "str" is of zero-length and so therefore not an integer */
-        }
-    }
+    /* a shared string object that has to grow gets its private copy from the reallocation itself */
+    if (str->length + STRING_DOUBLE_MAX_CHARS + 1 > str->capacity)
+        bool_appended = string_grow(str, str->length + STRING_DOUBLE_MAX_CHARS + 1);
     else
+        bool_appended = string_begin_write(str);
+
+    if (bool_appended)
     {
-        return_val = -1; /* "str" is NULL and cannot be converted. */
+        str->length                     +=  string_format_double(str->char_array + str->length, value);
+        str->char_array[str->length]    =   '\0';
+        str->flags                      &=  ~STRING_FLAG_HASHED;
     }
 
-    return return_val;
+    return bool_appended;
+}
+
+/** \brief Appends the shortest decimal form of a double to the string object through the string object's handle.
+ *
+ * \param str string_t** A pointer to the handle of the string object to append to.
+ * \param value double The value to append.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the number was appended.
+ *
+ * Like string_append_double(), but a string object kept in a single allocation is grown as a whole and *str is
+ * updated to its new address.
+ */
+int string_append_double_h(string_t** str, double value)
+{
+    if (str == NULL || *str == NULL)
+        return 0;
+
+    if ((*str)->length <= INT_MAX - 1 - STRING_DOUBLE_MAX_CHARS)
+        string_grow_h(str, (*str)->length + STRING_DOUBLE_MAX_CHARS + 1, 1);
+
+    return string_append_double(*str, value);
 }
 
 /** \brief Compares the contents of a string object and a standard C string (char*).
@@ -500,34 +1145,7 @@ int string_toint(const string_t* str)
  */
 int string_equal_cstring(const string_t* str1, const char* str2)
 {
-    const char* str1_cptr;
-    const char* str2_cptr;
-    int return_val = 1;
-
-    if (str1 != NULL && str2 != NULL)
-    {
-        if (str1->length == (int)(strlen(str2)))
-        {
-            for (str1_cptr = str1->char_array, str2_cptr = str2; *str1_cptr != '\0'; str1_cptr++, str2_cptr++)
-            {
-                if (*str1_cptr != *str2_cptr)
-                {
-                    return_val = 0; /* not equal */
-                    break;
-                }
-            }
-        }
-        else
-        {
-            return_val = 0; /* strings of different lengths are never equal */
-        }
-    }
-    else
-    {
-        return_val = 0; /* at least one of the function arguments is NULL */
-    }
-
-    return return_val;
+    return string_view_equal_cstring(string_view_from_string(str1), str2);
 }
 
 /** \brief Prints the string with or without appending a new line character onto the output.
@@ -560,42 +1178,7 @@ void string_print(string_t* str, int add_new_line)
  */
 int string_is_int(const string_t* str)
 {
-    const char* str_cptr;
-    int return_val = 1;
-
-    if (str != NULL)
-    {
-        if (str->length > 0)
-        {
-            for (str_cptr = str->char_array; *str_cptr != '\0'; str_cptr++)
-            {
-                if (!(*str_cptr >= '0' && *str_cptr <= '9') && *str_cptr != '-')
-                {
-                    return_val = 0; /* not a valid integer. */
-                    break;
-                }
-            }
-
-            for (str_cptr = str->char_array + 1; *str_cptr != '\0'; str_cptr++)
-            {
-                if (*str_cptr == '-')
-                {
-                    return_val = 0; /* not an integer. wrong place for a negative sign. */
-                    break;
-                }
-            }
-        }
-        else
-        {
-            return_val = 0; /* A zero-length string is not a valid integer. */
-        }
-    }
-    else
-    {
-        return_val = 0; /* NULL strings are not valid integers. */
-    }
-
-    return return_val;
+    return string_view_is_int(string_view_from_string(str));
 }
 
 /** \brief Reads in all the characters from the standard input stream and returns them a new string object.
@@ -624,48 +1207,29 @@ string_t* string_scan_s(void)
  */
 void string_scan2_s(string_t* dest)
 {
-    char curr_char;
-    char* buffer            =   calloc(200, sizeof(char));
-    int sizeof_buffer       =   200;
-    int len                 =   0;
-    char* temp              =   NULL;
+    int curr_char;
+    string_t* buffer        =   string_init();
 
-    curr_char = getc(stdin);
     if (buffer != NULL)
     {
-        while (curr_char != '\n')
+        curr_char = getc(stdin);
+
+        while (curr_char != '\n' && curr_char != EOF)
         {
-            if (len == sizeof_buffer)
-            {
-                temp = (char*)realloc(buffer, sizeof_buffer + 50);
-                if (temp != NULL)
-                {
-                    buffer              =       temp;
-                    sizeof_buffer       +=      50;
-                    strncat(buffer, &curr_char, 1);
-                    len++;
-                }
-                else
-                {
-                    free(buffer);
-                    buffer = NULL;
-                    break;
-                }
-            }
-            else
-            {
-                strncat(buffer, &curr_char, 1);
-                len++;
-            }
+            if (!string_grow(buffer, buffer->length + 2))
+                break;
+
+            buffer->char_array[buffer->length]      =   (char)curr_char;
+            buffer->char_array[buffer->length + 1]  =   '\0';
+            buffer->length++;
 
             curr_char = getc(stdin);
         }
 
-        if (buffer != NULL)
-        {
-            string_copy_cptr_sptr(dest, buffer);
-            free(buffer);
-        }
+        if (curr_char == '\n' || curr_char == EOF)
+            string_copy_sptr(dest, buffer);
+
+        string_destroy(buffer);
     }
 }
 
@@ -689,56 +1253,32 @@ void string_scan2_s(string_t* dest)
  * Python: str[x:]      C: beg_slice_indx = x, end_slice_indx = -1
  * For more information please look up the slice operator in the official Python documentation.
  * See http://docs.python.org for details.
+ * With copy-on-write enabled (see string_set_copy_on_write()) a slice running to the end of the source shares
+ * the source's heap char array until one of them is changed.
  */
 string_t* string_get_slice(const string_t* source, int beg_slice_indx, int end_slice_indx)
 {
     string_t* source_slice          =       NULL;
-    int bool_copy                   =       0;
+    int bool_copy                   =       1;
+    int slice_start, slice_length;
 
-    if (source != NULL)
+    if (source != NULL && string_resolve_slice(source->length, beg_slice_indx, end_slice_indx,
+                                               &slice_start, &slice_length))
     {
-        if (source->length > 0)
+        /* slices running to the end of the source can share its characters, others must be copied */
+        if (bool_copy_on_write && slice_start + slice_length == source->length)
         {
-            if (beg_slice_indx >= 0 && beg_slice_indx < source->length)
-            {
-                if (end_slice_indx > 0 && end_slice_indx <= source->length)
-                {
-                    if (beg_slice_indx < end_slice_indx)
-                    {
-                        /* perhaps I should allocate enough space for 50 extra chars like everything else? */
-                        source_slice = string_cust_init((end_slice_indx - beg_slice_indx) + 1);
-                        if (source_slice != NULL)
-                        {
-                            bool_copy = 1;
-                            end_slice_indx--;
-                        }
-                    }
-                }
-                else if (end_slice_indx == -1)
-                {
-                    source_slice = string_cust_init((source->length - beg_slice_indx) + 1);
-                    if (source_slice != NULL)
-                    {
-                        bool_copy           =       1;
-                        end_slice_indx      =       source->length -1;
-                    }
-                }
-            }
-            else if (beg_slice_indx == -1 && end_slice_indx == -1) /* imitate a python [:] slice operation. */
-            {                                                      /* as in a copy of the string. */
-                source_slice = string_cust_init(source->length + 1);
-                if (source_slice != NULL)
-                {
-                    bool_copy           =       1;
-                    beg_slice_indx      =       0;                  /* char positions in this case. */
-                    end_slice_indx      =       source->length - 1; /* not actual python slice indices */
-                }
-            }
-
-            if (bool_copy)
-                string_copy_range(source_slice, source, beg_slice_indx,
-                                  (end_slice_indx - beg_slice_indx) + 1);
+            source_slice = string_init();
+            if (source_slice != NULL && string_share_chars(source_slice, (string_t*)source, slice_start))
+                bool_copy = 0;
         }
+        else
+        {
+            source_slice = string_cust_init(slice_length + 1);
+        }
+
+        if (source_slice != NULL && bool_copy)
+            string_copy_range(source_slice, source, slice_start, slice_length);
     }
 
     return source_slice;
@@ -758,21 +1298,22 @@ string_t* string_get_slice(const string_t* source, int beg_slice_indx, int end_s
  */
 void string_copy_range(string_t* dest, const string_t* source, int src_strt_idx, int num_to_copy)
 {
-    char* temp = NULL;
     int dest_pos, source_pos;
 
-    if (dest != NULL && source != NULL)
+    if (string_begin_write(dest) && source != NULL)
     {
         if (source->length > 0)
         {
-            if (src_strt_idx >= 0 && src_strt_idx < source->length - 1)
+            if (src_strt_idx >= 0 && src_strt_idx < source->length)
             {
                 if (num_to_copy > 0)
                 {
                     if (num_to_copy > (source->length - src_strt_idx))
                         num_to_copy = source->length - src_strt_idx;
 
-                    if (num_to_copy <= dest->capacity)
+                    string_grow(dest, num_to_copy + 1);
+
+                    if (num_to_copy + 1 <= dest->capacity)
                     {
                         dest->length = 0;
                         for (dest_pos = 0, source_pos = src_strt_idx;
@@ -783,29 +1324,39 @@ void string_copy_range(string_t* dest, const string_t* source, int src_strt_idx,
                         }
                         dest->char_array[dest_pos] = '\0';
                     }
-                    else
-                    {
-                        temp = (char*)realloc(dest->char_array, num_to_copy + 51);
-                        if (temp != NULL)
-                        {
-                            dest->char_array        =       temp;
-                            dest->capacity          =       num_to_copy + 51;
-                            dest->length            =       0;
-                            for (dest_pos = 0, source_pos = src_strt_idx;
-                                 dest_pos < num_to_copy; dest_pos++, source_pos++)
-                            {
-                                dest->char_array[dest_pos] = source->char_array[source_pos];
-                                dest->length++;
-                            }
-                            dest->char_array[dest_pos] = '\0';
-                        }
-                    }
                 }
             }
         }
     }
 }
 
+/** \brief Copies a specified range from one string object to another through the destination's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object to copy to.
+ * \param source const string_t* A pointer to the source string object.
+ * \param src_strt_idx int The index of the first character to copy from the source string object.
+ * \param num_to_copy int The number of characters to copy from the source string object.
+ * \return void No return value.
+ *
+ * Like string_copy_range(), but a string object kept in a single allocation is grown as a whole and *dest is
+ * updated to its new address.
+ */
+void string_copy_range_h(string_t** dest, const string_t* source, int src_strt_idx, int num_to_copy)
+{
+    if (dest != NULL && *dest != NULL && source != NULL)
+    {
+        if (*dest != source && num_to_copy > 0 && src_strt_idx >= 0 && src_strt_idx < source->length)
+        {
+            if (num_to_copy > source->length - src_strt_idx)
+                num_to_copy = source->length - src_strt_idx;
+
+            string_grow_h(dest, num_to_copy + 1, 1);
+        }
+
+        string_copy_range(*dest, source, src_strt_idx, num_to_copy);
+    }
+}
+
 /** \brief Provides a wrapper for the standard fgets with additional dynamic memory management features.
  *
  * \param str string_t* A pointer to the string object in which to place the data from the stream.
@@ -816,33 +1367,44 @@ void string_copy_range(string_t* dest, const string_t* source, int src_strt_idx,
  */
 void string_fgets(string_t* dest_str, int len, FILE* strm)
 {
-    char* temp = NULL;
-
-    if (dest_str != NULL && strm != NULL)
+    if (string_begin_write(dest_str) && strm != NULL)
     {
         if (len > 0)
         {
-            if (len + 2 <= dest_str->capacity) /* + 2 to account for the \0 && \n characters appended by fgets() */
-            {
-                fgets(dest_str->char_array, len, strm);
-                dest_str->length = len;
-            }
-            else
+            string_grow(dest_str, len + 1); /* + 1 to account for the \0 character appended by fgets() */
+
+            if (len + 1 <= dest_str->capacity)
             {
-                temp = (char*)realloc(dest_str->char_array, len + 52);
-                if (temp != NULL)
-                {
-                    dest_str->capacity          =       len + 52;
-                    dest_str->char_array        =       temp;
+                if (fgets(dest_str->char_array, len + 1, strm) == NULL)
+                    dest_str->char_array[0] = '\0'; /* nothing could be read */
 
-                    fgets(dest_str->char_array, len, strm);
-                    dest_str->length = len;
-                }
+                dest_str->length = (int)strlen(dest_str->char_array);
             }
         }
     }
 }
 
+/** \brief Reads characters from a stream into a string object through the string object's handle.
+ *
+ * \param dest_str string_t** A pointer to the handle of the string object in which to place the data.
+ * \param len int The number of characters to get from the stream.
+ * \param strm FILE* A pointer to the stream to read from.
+ * \return void No return value.
+ *
+ * Like string_fgets(), but a string object kept in a single allocation is grown as a whole and *dest_str is
+ * updated to its new address.
+ */
+void string_fgets_h(string_t** dest_str, int len, FILE* strm)
+{
+    if (dest_str != NULL && *dest_str != NULL)
+    {
+        if (len > 0 && len < INT_MAX && strm != NULL)
+            string_grow_h(dest_str, len + 1, 1);
+
+        string_fgets(*dest_str, len, strm);
+    }
+}
+
 /** \brief Imitates the Python "in" operator.
  *
  * \param str_to_search string_t* A pointer to the string object in which to search for the existence of str_to_find.
@@ -853,18 +1415,7 @@ void string_fgets(string_t* dest_str, int len, FILE* strm)
  */
 int string_in(string_t* str_to_search, char* str_to_find)
 {
-    int ret_val = 0;
-
-    if (str_to_search != NULL && str_to_find != NULL)
-    {
-        if (str_to_search->length > 0 && strlen(str_to_find) > 0)
-        {
-            if (string_find_cstr(str_to_search, str_to_find, 0) >= 0)
-                ret_val = 1;
-        }
-    }
-
-    return ret_val;
+    return string_view_in(string_view_from_string(str_to_search), str_to_find);
 }
 
 /** \brief Determines whether str_to_find exists in str_to_search.
@@ -874,11 +1425,11 @@ int string_in(string_t* str_to_search, char* str_to_find)
  * \return int A Boolean value, 1 for True and 0 for False, to indicate whether or not
  * str_to_find was found in str_to_search.
  *
- * This is a simple function wrapper for string_in
+ * A NULL str_to_find is never found.
  */
 int string_in2(string_t* str_to_search, string_t* str_to_find)
 {
-    return string_in(str_to_search, str_to_find->char_array);
+    return string_view_find(string_view_from_string(str_to_search), string_view_from_string(str_to_find), 0) >= 0;
 }
 
 /** \brief Searches for the specified C string within the string object and returns its index if found.
@@ -891,49 +1442,7 @@ int string_in2(string_t* str_to_search, string_t* str_to_find)
  */
 int string_find_cstr(string_t* str_to_search, char* str_to_find, int search_strt_pos)
 {
-    int ret_val = -1, str_to_find_pos, str_to_search_pos;
-
-    if (str_to_search != NULL && str_to_find != NULL)
-    {
-        if (search_strt_pos >= 0 && search_strt_pos < str_to_search->length)
-        {
-            if (strlen(str_to_find) > 0 && str_to_search->length > 0)
-            {
-                str_to_find_pos         =       0;
-                str_to_search_pos       =       search_strt_pos;
-
-                while (str_to_search_pos < str_to_search->length)
-                {
-                    if (str_to_search->char_array[str_to_search_pos] == str_to_find[str_to_find_pos])
-                    {
-                        ret_val = str_to_search_pos;
-                        str_to_find_pos++;
-                        str_to_search_pos++;
-
-                        while (str_to_find_pos < (int)strlen(str_to_find) && str_to_search_pos < str_to_search->length)
-                        {
-                            if (str_to_search->char_array[str_to_search_pos] != str_to_find[str_to_find_pos])
-                            {
-                                ret_val             =       -1;
-                                str_to_find_pos     =       0;
-                                break;
-                            }
-
-                            str_to_find_pos++;
-                            str_to_search_pos++;
-                        }
-
-                        if (str_to_find_pos > 0)
-                            break;
-                    }
-
-                    str_to_search_pos++;
-                }
-            }
-        }
-    }
-
-    return ret_val;
+    return string_view_find_cstr(string_view_from_string(str_to_search), str_to_find, search_strt_pos);
 }
 
 /** \brief Returns the index of the first occurrence of str_to_find in str_to_search, starting at search_strt_pos.
@@ -943,11 +1452,12 @@ int string_find_cstr(string_t* str_to_search, char* str_to_find, int search_strt
  * \param search_strt_pos int The index to start the search in str_to_search.
  * \return int The index of the found occurrence or -1 if not found.
  *
- * Provides a function wrapper for string_find_cstr.
+ * A NULL str_to_find is never found.
  */
 int string_find(string_t* str_to_search, string_t* str_to_find, int search_strt_pos)
 {
-    return string_find_cstr(str_to_search, str_to_find->char_array, search_strt_pos);
+    return string_view_find(string_view_from_string(str_to_search), string_view_from_string(str_to_find),
+                            search_strt_pos);
 }
 
 /** \brief Overwrites a specified range in the string object with a new value.
@@ -966,7 +1476,7 @@ void string_set_range(string_t* dest, char* replacement_str, int start_pos, int
 {/* add one-character replace test for this function */
     int dest_pos, replacement_str_pos, count_to_write;
 
-    if (dest != NULL && replacement_str != NULL)
+    if (string_begin_write(dest) && replacement_str != NULL)
     {
         if (start_pos >= 0 && start_pos < dest->length && end_pos >= 0 && end_pos < dest->length)
         {
@@ -1008,6 +1518,225 @@ void string_set_range2(string_t* dest, string_t* replacement_str, int start_pos,
     string_set_range(dest, replacement_str->char_array, start_pos, end_pos);
 }
 
+/** \brief Replaces a range of characters in the string object with another run of characters.
+ *
+ * \param dest string_t* A pointer to the string object to change.
+ * \param pos int Character position of the range to replace--from 0 up to and including dest->length.
+ * \param remove_len int Number of characters to remove from pos onwards. Ranges reaching past the end of the
+ * string are cut short at the end.
+ * \param insert_ptr const char* The characters to put in place of the removed ones--may be NULL if insert_len is 0.
+ * \param insert_len int Number of characters to insert.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the range was replaced.
+ *
+ * Inserts, deletes or replaces in place: the rest of the string is moved with a single memmove() and the string
+ * object is reallocated at most once, geometrically, when it grows past its capacity. The length and the
+ * terminating null character are kept up to date. The characters to insert may come from dest itself--they
+ * are copied aside first in that case. Nothing is changed if memory runs out.
+ */
+int string_splice(string_t* dest, int pos, int remove_len, const char* insert_ptr, int insert_len)
+{
+    char* insert_copy           =   NULL;
+    int bool_spliced            =   0;
+    int tail_length, new_length;
+
+    if (dest == NULL || (dest->flags & STRING_FLAG_IMMUTABLE) || pos < 0 || pos > dest->length || remove_len < 0
+        || insert_len < 0 || (insert_ptr == NULL && insert_len > 0))
+        return 0;
+
+    if (remove_len > dest->length - pos)
+        remove_len = dest->length - pos;
+
+    tail_length = dest->length - pos - remove_len;
+
+    if (insert_len > INT_MAX - 1 - pos - tail_length)
+        return 0;
+
+    new_length = pos + insert_len + tail_length;
+
+    /* characters inserted from dest's own buffer would be moved by the splice itself */
+    if (insert_len > 0 && insert_ptr >= dest->char_array && insert_ptr < dest->char_array + dest->capacity)
+    {
+        insert_copy = (char*)string_mem_alloc(insert_len);
+
+        if (insert_copy == NULL)
+            return 0;
+
+        memcpy(insert_copy, insert_ptr, insert_len);
+        insert_ptr = insert_copy;
+    }
+
+    /* a shared string object that has to grow gets its private copy from the reallocation itself */
+    if (new_length + 1 > dest->capacity)
+        bool_spliced = string_grow(dest, new_length + 1);
+    else
+        bool_spliced = string_begin_write(dest);
+
+    if (bool_spliced)
+    {
+        if (insert_len != remove_len)
+            memmove(dest->char_array + pos + insert_len, dest->char_array + pos + remove_len, tail_length + 1);
+
+        if (insert_len > 0)
+            memcpy(dest->char_array + pos, insert_ptr, insert_len);
+
+        dest->length    =   new_length;
+        dest->flags     &=  ~STRING_FLAG_HASHED;
+    }
+
+    if (insert_copy != NULL)
+        string_mem_free(insert_copy, insert_len);
+
+    return bool_spliced;
+}
+
+/** \brief Replaces a range of characters in the string object through the string object's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object to change.
+ * \param pos int Character position of the range to replace.
+ * \param remove_len int Number of characters to remove from pos onwards.
+ * \param insert_ptr const char* The characters to put in place of the removed ones.
+ * \param insert_len int Number of characters to insert.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the range was replaced.
+ *
+ * Like string_splice(), but a string object kept in a single allocation is grown as a whole and *dest is
+ * updated to its new address.
+ */
+int string_splice_h(string_t** dest, int pos, int remove_len, const char* insert_ptr, int insert_len)
+{
+    string_t* str;
+
+    if (dest == NULL || *dest == NULL)
+        return 0;
+
+    str = *dest;
+
+    /* growing the whole object would move characters inserted from it, so leave those to string_splice() */
+    if (pos >= 0 && pos <= str->length && remove_len >= 0 && insert_len > 0 && insert_ptr != NULL
+        && !(insert_ptr >= (const char*)str && insert_ptr < (const char*)str + string_object_size(str->inline_capacity))
+        && !(insert_ptr >= str->char_array && insert_ptr < str->char_array + str->capacity)
+        && insert_len <= INT_MAX - 1 - str->length)
+    {
+        if (remove_len > str->length - pos)
+            remove_len = str->length - pos;
+
+        string_grow_h(dest, str->length - remove_len + insert_len + 1, 1);
+    }
+
+    return string_splice(*dest, pos, remove_len, insert_ptr, insert_len);
+}
+
+/** \brief Inserts a C string into the string object.
+ *
+ * \param dest string_t* A pointer to the string object to insert into.
+ * \param pos int Character position to insert at--dest->length appends.
+ * \param str_to_insert const char* The C string to insert.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the C string was inserted.
+ *
+ * See string_splice().
+ */
+int string_insert(string_t* dest, int pos, const char* str_to_insert)
+{
+    int bool_inserted = 0;
+
+    if (str_to_insert != NULL)
+        bool_inserted = string_splice(dest, pos, 0, str_to_insert, (int)strlen(str_to_insert));
+
+    return bool_inserted;
+}
+
+/** \brief Inserts a C string into the string object through the string object's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object to insert into.
+ * \param pos int Character position to insert at--(*dest)->length appends.
+ * \param str_to_insert const char* The C string to insert.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the C string was inserted.
+ *
+ * Like string_insert(), but a string object kept in a single allocation is grown as a whole and *dest is
+ * updated to its new address.
+ */
+int string_insert_h(string_t** dest, int pos, const char* str_to_insert)
+{
+    int bool_inserted = 0;
+
+    if (str_to_insert != NULL)
+        bool_inserted = string_splice_h(dest, pos, 0, str_to_insert, (int)strlen(str_to_insert));
+
+    return bool_inserted;
+}
+
+/** \brief Removes a range of characters from the string object.
+ *
+ * \param dest string_t* A pointer to the string object to remove characters from.
+ * \param pos int Character position of the first character to remove.
+ * \param num_to_erase int Number of characters to remove. Ranges reaching past the end of the string are cut
+ * short at the end.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not the range was removed.
+ *
+ * See string_splice(). Erasing never reallocates the string object, apart from giving a string object that
+ * shares its characters its own copy of them.
+ */
+int string_erase(string_t* dest, int pos, int num_to_erase)
+{
+    return string_splice(dest, pos, num_to_erase, NULL, 0);
+}
+
+/** \brief Counts the non-overlapping occurrences of a run of characters.
+ *
+ * \param chars const char* The characters to search.
+ * \param length int Number of characters to search.
+ * \param str_to_find const char* The characters to count.
+ * \param find_length int Number of characters to count--at least 1.
+ * \return int The number of occurrences, counted from left to right.
+ *
+ */
+static int string_count_matches(const char* chars, int length, const char* str_to_find, int find_length)
+{
+    int count   =   0;
+    int pos     =   0;
+    int found_at_pos;
+
+    while ((found_at_pos = string_search(chars + pos, length - pos, str_to_find, find_length)) >= 0)
+    {
+        count++;
+        pos += found_at_pos + find_length;
+    }
+
+    return count;
+}
+
+/** \brief Copies characters while replacing every occurrence of a run of characters.
+ *
+ * \param dest char* Where to write the result, including a terminating null character.
+ * \param source const char* The characters to copy, followed by a null character.
+ * \param source_length int Number of characters to copy.
+ * \param str_to_replace const char* The characters to replace.
+ * \param replace_length int Number of characters to replace--at least 1.
+ * \param replacement_text const char* The characters to put in their place.
+ * \param replacement_length int Number of replacement characters.
+ * \return void Nothing.
+ *
+ * dest may overlap source as long as it starts at or before it and the result never catches up with the
+ * characters not yet read--which holds when dest starts as many characters before source as the result
+ * is longer than the source. Neither str_to_replace nor replacement_text may overlap dest.
+ */
+static void string_replace_copy(char* dest, const char* source, int source_length, const char* str_to_replace,
+                                int replace_length, const char* replacement_text, int replacement_length)
+{
+    int pos = 0;
+    int found_at_pos;
+
+    while ((found_at_pos = string_search(source + pos, source_length - pos, str_to_replace, replace_length)) >= 0)
+    {
+        memmove(dest, source + pos, found_at_pos);
+        dest    +=  found_at_pos;
+        memcpy(dest, replacement_text, replacement_length);
+        dest    +=  replacement_length;
+        pos     +=  found_at_pos + replace_length;
+    }
+
+    memmove(dest, source + pos, source_length - pos + 1);
+}
+
 /** \brief Replaces the first occurrence of str_to_replace with replacement_text in the string object pointed to by dest.
  *
  * \param dest string_t* A pointer to the string object in which to do the replacements.
@@ -1016,18 +1745,16 @@ void string_set_range2(string_t* dest, string_t* replacement_str, int start_pos,
  * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not a replacement was made.
  *
  * Subsequent, identical calls to the function with the same parameters will replace the next occurrence of
- * str_to_replace--if found.
+ * str_to_replace--if found. Use string_replace_all() to replace every occurrence at once.
  */
 int string_replace(string_t* dest, char* str_to_replace, char* replacement_text)
 {
     static int search_strt_pos              =       0;
     int bool_replaced                       =       0;
-    int size_diff                           =       0; 
-    char* temp                              =       NULL;
     static string_t* old_dest               =       NULL;
     static char* old_str_to_replace         =       NULL;
     static char* old_replacement_text       =       NULL;
-    int dest_pos, found_at_pos, replacement_end_pos;
+    int found_at_pos, replace_length;
 
     if (old_dest == NULL && old_str_to_replace == NULL && old_replacement_text == NULL)
     {
@@ -1036,7 +1763,7 @@ int string_replace(string_t* dest, char* str_to_replace, char* replacement_text)
         old_str_to_replace          =       str_to_replace;
     }
 
-    if (dest != NULL && str_to_replace != NULL && replacement_text != NULL)
+    if (string_begin_write(dest) && str_to_replace != NULL && replacement_text != NULL)
     {
         if (dest->length > 0 && strlen(str_to_replace) > 0 && strlen(replacement_text) > 0)
         {
@@ -1048,53 +1775,13 @@ int string_replace(string_t* dest, char* str_to_replace, char* replacement_text)
                 old_str_to_replace          =       str_to_replace;
             }
 
-            size_diff           =       (int)(fabs((double)((int)strlen(str_to_replace) - (int)strlen(replacement_text))));
+            replace_length      =       (int)strlen(str_to_replace);
             found_at_pos        =       string_find_cstr(dest, str_to_replace, search_strt_pos);
             search_strt_pos     =       found_at_pos + 1;
 
             if (found_at_pos > -1)
-
-            {
-                if (strlen(replacement_text) > strlen(str_to_replace))
-                {
-                    if (dest->length + size_diff > dest->capacity)
-                    {
-                        temp = (char*)realloc(dest->char_array, dest->capacity + size_diff + 50);
-                    }
-
-                    if (temp != NULL || dest->length + size_diff <= dest->capacity)
-                    {
-                        if (temp != NULL)
-                            dest->capacity = dest->capacity + size_diff + 50;
-
-                        /* make room to insert the longer phrase */
-                        for (dest_pos = dest->length - 1; dest_pos > found_at_pos + (int)strlen(str_to_replace) - 1; dest_pos--)
-                            dest->char_array[dest_pos + size_diff] = dest->char_array[dest_pos];
-
-                        dest->length            +=      size_diff;
-                        replacement_end_pos     =       found_at_pos + strlen(replacement_text) - 1;
-                        string_set_range(dest, replacement_text, found_at_pos, replacement_end_pos);
-                        bool_replaced           =       1;
-                    }
-                }
-                else if (strlen(replacement_text) < strlen(str_to_replace))
-                {
-                    /* remove unneeded characters */
-                    for (dest_pos = found_at_pos + strlen(replacement_text); dest_pos < dest->length - 1; dest_pos++)
-                        dest->char_array[dest_pos] = dest->char_array[dest_pos + size_diff];
-
-                    dest->length            -=      size_diff;
-                    replacement_end_pos     =       found_at_pos + strlen(replacement_text) - 1;
-                    string_set_range(dest, replacement_text, found_at_pos, replacement_end_pos);
-                    bool_replaced           =       1;
-                }
-                else
-                {
-                    replacement_end_pos     =       found_at_pos + strlen(replacement_text) - 1;
-                    string_set_range(dest, replacement_text, found_at_pos, replacement_end_pos);
-                    bool_replaced           =       1;
-                }
-            }
+                bool_replaced = string_splice(dest, found_at_pos, replace_length, replacement_text,
+                                              (int)strlen(replacement_text));
         }
     }
 
@@ -1117,3 +1804,366 @@ int string_replace2(string_t* dest, string_t* str_to_replace, string_t* replacem
 {
     return string_replace(dest, str_to_replace->char_array, replacement_text->char_array);
 }
+
+/** \brief Replaces the next occurrence of str_to_replace with replacement_text through the string object's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object in which to do the replacements.
+ * \param str_to_replace char* The C string to replace.
+ * \param replacement_text char* The C string to use as a replacement.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not a replacement was made.
+ *
+ * Like string_replace(), but a string object kept in a single allocation is grown as a whole and *dest is
+ * updated to its new address.
+ */
+int string_replace_h(string_t** dest, char* str_to_replace, char* replacement_text)
+{
+    int size_diff;
+
+    if (dest == NULL || *dest == NULL)
+        return 0;
+
+    if (str_to_replace != NULL && replacement_text != NULL)
+    {
+        size_diff = (int)strlen(replacement_text) - (int)strlen(str_to_replace);
+
+        if (size_diff > 0 && string_find_cstr(*dest, str_to_replace, 0) >= 0)
+            string_grow_h(dest, (*dest)->length + size_diff + 1, 1);
+    }
+
+    return string_replace(*dest, str_to_replace, replacement_text);
+}
+
+/** \brief Replaces every occurrence of str_to_replace with replacement_text in a single pass.
+ *
+ * \param dest string_t* A pointer to the string object in which to do the replacements.
+ * \param str_to_replace const char* The C string to replace.
+ * \param replacement_text const char* The C string to put in its place--it may be empty.
+ * \return int The number of replacements made, or -1 if there was not enough memory to make them.
+ *
+ * Occurrences are replaced from left to right without overlapping, and text put in by a replacement is never
+ * searched again. The occurrences are counted first so that the result is written in one linear pass--in place
+ * when it fits the string object's capacity, otherwise into a single new allocation of the final size.
+ * Unlike string_replace(), the function keeps no state between calls, so it is safe to use from several threads
+ * on different string objects.
+ */
+int string_replace_all(string_t* dest, const char* str_to_replace, const char* replacement_text)
+{
+    char* new_array                 =   NULL;
+    const char* buffer_end;
+    long long new_length;
+    int count                       =   0;
+    int replace_length, replacement_length, length_increase;
+
+    if (dest == NULL || (dest->flags & STRING_FLAG_IMMUTABLE) || str_to_replace == NULL || replacement_text == NULL)
+        return 0;
+
+    replace_length      =   (int)strlen(str_to_replace);
+    replacement_length  =   (int)strlen(replacement_text);
+
+    if (replace_length > 0)
+        count = string_count_matches(dest->char_array, dest->length, str_to_replace, replace_length);
+
+    if (count > 0)
+    {
+        new_length = (long long)dest->length + (long long)count * (replacement_length - replace_length);
+
+        if (new_length >= INT_MAX)
+            return -1;
+
+        buffer_end          =   dest->char_array + dest->capacity;
+        length_increase     =   new_length > dest->length ? (int)new_length - dest->length : 0;
+
+        if (new_length + 1 <= dest->capacity && !(dest->flags & STRING_FLAG_SHARED)
+            && !(str_to_replace >= dest->char_array && str_to_replace < buffer_end)
+            && !(replacement_text >= dest->char_array && replacement_text < buffer_end))
+        {
+            /* move the text to the end of the buffer, so that the result can be written over it from the front */
+            if (length_increase > 0)
+                memmove(dest->char_array + length_increase, dest->char_array, dest->length + 1);
+
+            string_replace_copy(dest->char_array, dest->char_array + length_increase, dest->length, str_to_replace,
+                                replace_length, replacement_text, replacement_length);
+        }
+        else
+        {
+            if (dest->arena != NULL)
+                new_array = (char*)string_arena_alloc(dest->arena, (size_t)new_length + 1);
+            else
+                new_array = (char*)string_mem_alloc((size_t)new_length + 1);
+
+            if (new_array == NULL)
+                return -1;
+
+            string_replace_copy(new_array, dest->char_array, dest->length, str_to_replace, replace_length,
+                                replacement_text, replacement_length);
+
+            if (dest->arena == NULL)
+                string_release_chars(dest); /* arena memory is only reclaimed with the arena */
+
+            dest->char_array    =   new_array;
+            dest->capacity      =   (int)new_length + 1;
+        }
+
+        dest->length    =   (int)new_length;
+        dest->flags     &=  ~STRING_FLAG_HASHED;
+    }
+
+    return count;
+}
+
+/** \brief Replaces every occurrence of str_to_replace with replacement_text through the string object's handle.
+ *
+ * \param dest string_t** A pointer to the handle of the string object in which to do the replacements.
+ * \param str_to_replace const char* The C string to replace.
+ * \param replacement_text const char* The C string to put in its place--it may be empty.
+ * \return int The number of replacements made, or -1 if there was not enough memory to make them.
+ *
+ * Like string_replace_all(), but a string object kept in a single allocation is grown as a whole and *dest is
+ * updated to its new address.
+ */
+int string_replace_all_h(string_t** dest, const char* str_to_replace, const char* replacement_text)
+{
+    int count, size_diff;
+
+    if (dest == NULL || *dest == NULL)
+        return 0;
+
+    if (str_to_replace != NULL && replacement_text != NULL && str_to_replace[0] != '\0'
+        && (*dest)->arena == NULL && (*dest)->char_array == (*dest)->inline_buffer)
+    {
+        size_diff = (int)strlen(replacement_text) - (int)strlen(str_to_replace);
+
+        if (size_diff > 0)
+        {
+            count = string_count_matches((*dest)->char_array, (*dest)->length, str_to_replace,
+                                         (int)strlen(str_to_replace));
+
+            if (count > 0 && (long long)(*dest)->length + (long long)count * size_diff < INT_MAX
+                && !string_grow_h(dest, (*dest)->length + count * size_diff + 1, 0))
+                    return -1;
+        }
+    }
+
+    return string_replace_all(*dest, str_to_replace, replacement_text);
+}
+
+/* Replacement table prepared by string_replace_many(): the usable entries grouped by the first byte of their from
+   text, longest first within each group, with the lengths of their texts measured once. */
+typedef struct string_replace_table_t
+{
+    const string_replacement_t* entries;
+    const int* order; /* entry indexes--order[bucket_start[c]..bucket_start[c + 1]) are the ones starting with c */
+    const int* from_lengths;
+    const int* to_lengths;
+    int bucket_start[257];
+} string_replace_table_t;
+
+/** \brief Finds the longest table entry matching at a position, or the run of characters no entry can start.
+ *
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters left to scan--at least 1.
+ * \param table const string_replace_table_t* The prepared replacement table.
+ * \param matched_entry int* Receives the index of the matching entry, or -1 if none matches.
+ * \return int The number of characters the match covers, or the number of characters to copy unchanged.
+ *
+ */
+static int string_replace_many_step(const char* chars, int length, const string_replace_table_t* table,
+                                    int* matched_entry)
+{
+    int pos = 0;
+    int bucket_pos, entry;
+    unsigned char byte = (unsigned char)chars[0];
+
+    *matched_entry = -1;
+
+    for (bucket_pos = table->bucket_start[byte]; bucket_pos < table->bucket_start[byte + 1]; bucket_pos++)
+    {
+        entry = table->order[bucket_pos];
+
+        if (table->from_lengths[entry] <= length
+            && memcmp(chars, table->entries[entry].from, table->from_lengths[entry]) == 0)
+        {
+            *matched_entry = entry;
+            return table->from_lengths[entry];
+        }
+    }
+
+    /* nothing matches here: skip to the next byte that starts an entry */
+    do
+    {
+        byte = (unsigned char)chars[++pos];
+    } while (pos < length && table->bucket_start[byte] == table->bucket_start[byte + 1]);
+
+    return pos;
+}
+
+/** \brief Runs a prepared replacement table over some characters, optionally writing the result.
+ *
+ * \param source const char* The characters to scan, followed by a null character.
+ * \param length int Number of characters to scan.
+ * \param table const string_replace_table_t* The prepared replacement table.
+ * \param dest char* Where to write the result and a terminating null character, or NULL to only measure it.
+ * It may be source itself when no entry makes the text longer.
+ * \param count int* Receives the number of replacements.
+ * \return long long The length of the result.
+ *
+ */
+static long long string_replace_many_pass(const char* source, int length, const string_replace_table_t* table,
+                                          char* dest, int* count)
+{
+    long long result_length     =   0;
+    int pos                     =   0;
+    int step, entry;
+
+    *count = 0;
+
+    while (pos < length)
+    {
+        step = string_replace_many_step(source + pos, length - pos, table, &entry);
+
+        if (entry >= 0)
+        {
+            if (dest != NULL)
+                memcpy(dest + result_length, table->entries[entry].to, table->to_lengths[entry]);
+
+            result_length   +=  table->to_lengths[entry];
+            (*count)++;
+        }
+        else
+        {
+            if (dest != NULL)
+                memmove(dest + result_length, source + pos, step);
+
+            result_length += step;
+        }
+
+        pos += step;
+    }
+
+    if (dest != NULL)
+        dest[result_length] = '\0';
+
+    return result_length;
+}
+
+/** \brief Applies a table of replacements to a string object in a single left-to-right scan.
+ *
+ * \param dest string_t* A pointer to the string object in which to do the replacements.
+ * \param table const string_replacement_t* An array of from/to pairs.
+ * \param num_replacements int Number of entries in table.
+ * \return int The number of replacements made, or -1 if there was not enough memory to make them.
+ *
+ * At each position the longest entry whose from text matches is replaced--the first such entry if several
+ * have the same from text--and scanning resumes after it, so replacement text is never searched again.
+ * Entries with a NULL or empty from text or a NULL to text are ignored. The result is measured first and then
+ * written in one pass, in place when no entry makes the text longer, otherwise into a single new allocation of
+ * the final size. Escaping text for HTML takes one table and one call:
+ *
+ *     string_replacement_t html[] = {{"&", "&amp;"}, {"<", "&lt;"}, {">", "&gt;"}, {"\"", "&quot;"}};
+ *     string_replace_many(str, html, 4);
+ */
+int string_replace_many(string_t* dest, const string_replacement_t* table, int num_replacements)
+{
+    string_replace_table_t prepared;
+    int stack_scratch[3 * 16];
+    int* scratch                =   stack_scratch;
+    int* order;
+    int* from_lengths;
+    int* to_lengths;
+    char* new_array             =   NULL;
+    long long new_length;
+    int bool_growing            =   0;
+    int count                   =   0;
+    int entry, num_entries, pos, byte;
+
+    if (dest == NULL || (dest->flags & STRING_FLAG_IMMUTABLE) || table == NULL || num_replacements < 1)
+        return 0;
+
+    if (num_replacements > 16)
+    {
+        scratch = (int*)string_mem_alloc((size_t)num_replacements * 3 * sizeof(int));
+
+        if (scratch == NULL)
+            return -1;
+    }
+
+    order           =   scratch;
+    from_lengths    =   order + num_replacements;
+    to_lengths      =   from_lengths + num_replacements;
+
+    /* sort the usable entries by first byte, longest from text first, keeping table order among equals */
+    for (byte = 0; byte < 257; byte++)
+        prepared.bucket_start[byte] = 0;
+
+    for (entry = 0, num_entries = 0; entry < num_replacements; entry++)
+    {
+        if (table[entry].from != NULL && table[entry].from[0] != '\0' && table[entry].to != NULL)
+        {
+            from_lengths[entry]     =   (int)strlen(table[entry].from);
+            to_lengths[entry]       =   (int)strlen(table[entry].to);
+            bool_growing            |=  to_lengths[entry] > from_lengths[entry];
+            byte                    =   (unsigned char)table[entry].from[0];
+            prepared.bucket_start[byte + 1]++;
+
+            for (pos = num_entries++; pos > 0 && ((unsigned char)table[order[pos - 1]].from[0] > byte
+                 || ((unsigned char)table[order[pos - 1]].from[0] == byte && from_lengths[order[pos - 1]] < from_lengths[entry]));
+                 pos--)
+                    order[pos] = order[pos - 1];
+
+            order[pos] = entry;
+        }
+    }
+
+    for (byte = 0; byte < 256; byte++)
+        prepared.bucket_start[byte + 1] += prepared.bucket_start[byte];
+
+    prepared.entries        =   table;
+    prepared.order          =   order;
+    prepared.from_lengths   =   from_lengths;
+    prepared.to_lengths     =   to_lengths;
+
+    new_length = string_replace_many_pass(dest->char_array, dest->length, &prepared, NULL, &count);
+
+    if (count > 0)
+    {
+        dest->flags &= ~STRING_FLAG_HASHED;
+
+        if (new_length >= INT_MAX)
+        {
+            count = -1;
+        }
+        else if (!bool_growing && !(dest->flags & STRING_FLAG_SHARED))
+        {
+            dest->length = (int)string_replace_many_pass(dest->char_array, dest->length, &prepared, dest->char_array,
+                                                          &count);
+        }
+        else
+        {
+            if (dest->arena != NULL)
+                new_array = (char*)string_arena_alloc(dest->arena, (size_t)new_length + 1);
+            else
+                new_array = (char*)string_mem_alloc((size_t)new_length + 1);
+
+            if (new_array != NULL)
+            {
+                string_replace_many_pass(dest->char_array, dest->length, &prepared, new_array, &count);
+
+                if (dest->arena == NULL)
+                    string_release_chars(dest); /* arena memory is only reclaimed with the arena */
+
+                dest->char_array    =   new_array;
+                dest->capacity      =   (int)new_length + 1;
+                dest->length        =   (int)new_length;
+            }
+            else
+            {
+                count = -1;
+            }
+        }
+    }
+
+    if (scratch != stack_scratch)
+        string_mem_free(scratch, (size_t)num_replacements * 3 * sizeof(int));
+
+    return count;
+}
@@ -0,0 +1,208 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Pluggable memory allocation for libString along with allocation statistics.
+* Filename: StringAlloc.c */
+
+#include <stdlib.h>
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+static void* default_malloc(size_t size, void* context);
+
+static void* default_realloc(void* block, size_t size, void* context);
+
+static void default_free(void* block, void* context);
+
+static string_malloc_fn malloc_hook         =   default_malloc;
+static string_realloc_fn realloc_hook       =   default_realloc;
+static string_free_fn free_hook             =   default_free;
+static void* hook_context                   =   NULL;
+static string_alloc_stats_t alloc_stats;
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string allocator implementation                        *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+static void* default_malloc(size_t size, void* context)
+{
+    (void)context;
+    return malloc(size);
+}
+
+static void* default_realloc(void* block, size_t size, void* context)
+{
+    (void)context;
+    return realloc(block, size);
+}
+
+static void default_free(void* block, void* context)
+{
+    (void)context;
+    free(block);
+}
+
+/** \brief Records that size more bytes are live and raises the peak if necessary.
+ *
+ * \param size unsigned long long The number of bytes that became live.
+ * \return void Nothing.
+ *
+ */
+static void string_stats_add_live(unsigned long long size)
+{
+    unsigned long long live = STRING_ATOMIC_ADD(alloc_stats.bytes_live, size);
+
+    if (live > alloc_stats.peak_bytes_live)
+        alloc_stats.peak_bytes_live = live; /* a racing update can only make the peak slightly low */
+}
+
+/** \brief Installs the functions libString uses to allocate, reallocate and free memory.
+ *
+ * \param malloc_fn string_malloc_fn The allocation function.
+ * \param realloc_fn string_realloc_fn The reallocation function.
+ * \param free_fn string_free_fn The deallocation function.
+ * \param context void* A user pointer passed to every call of the three functions.
+ * \return void Nothing.
+ *
+ * Passing NULL for all three functions restores the standard library's malloc(), realloc() and free().
+ * The allocator must only be changed while no string objects or arenas exist, since memory allocated by one
+ * allocator is freed with whichever allocator is installed at the time. Installing an allocator resets the
+ * allocation counters as string_reset_alloc_stats() does; the live byte count carries over.
+ */
+void string_set_allocator(string_malloc_fn malloc_fn, string_realloc_fn realloc_fn, string_free_fn free_fn,
+                          void* context)
+{
+    if (malloc_fn != NULL && realloc_fn != NULL && free_fn != NULL)
+    {
+        malloc_hook         =   malloc_fn;
+        realloc_hook        =   realloc_fn;
+        free_hook           =   free_fn;
+        hook_context        =   context;
+        string_reset_alloc_stats();
+    }
+    else if (malloc_fn == NULL && realloc_fn == NULL && free_fn == NULL)
+    {
+        malloc_hook         =   default_malloc;
+        realloc_hook        =   default_realloc;
+        free_hook           =   default_free;
+        hook_context        =   NULL;
+        string_reset_alloc_stats();
+    }
+}
+
+/** \brief Reads the allocation statistics of the installed allocator.
+ *
+ * \param stats string_alloc_stats_t* A pointer to the structure to fill in.
+ * \return void Nothing.
+ *
+ * The counters cover every allocation made by libString--string objects, char arrays and arena blocks--since
+ * the allocator was installed or the statistics were last reset. bytes_live is never reset: it is the memory
+ * libString holds right now. Taking a snapshot before and after a piece of
+ * code shows how much memory traffic it causes.
+ */
+void string_get_alloc_stats(string_alloc_stats_t* stats)
+{
+    if (stats != NULL)
+        memcpy(stats, &alloc_stats, sizeof(string_alloc_stats_t));
+}
+
+/** \brief Sets all the allocation counters back to zero.
+ *
+ * \param None
+ * \return void Nothing.
+ *
+ * The live byte count is kept, since the memory it describes is still allocated; the peak restarts from it.
+ */
+void string_reset_alloc_stats(void)
+{
+    alloc_stats.allocations         =   0;
+    alloc_stats.reallocations       =   0;
+    alloc_stats.frees               =   0;
+    alloc_stats.bytes_requested     =   0;
+    alloc_stats.peak_bytes_live     =   alloc_stats.bytes_live;
+}
+
+/** \brief Allocates memory through the installed allocator.
+ *
+ * \param size size_t The number of bytes to allocate.
+ * \return void* A pointer to the allocated memory or NULL if it could not be allocated.
+ *
+ */
+void* string_mem_alloc(size_t size)
+{
+    void* block = malloc_hook(size, hook_context);
+
+    if (block != NULL)
+    {
+        STRING_ATOMIC_ADD(alloc_stats.allocations, 1);
+        STRING_ATOMIC_ADD(alloc_stats.bytes_requested, size);
+        string_stats_add_live(size);
+    }
+
+    return block;
+}
+
+/** \brief Allocates zero-filled memory through the installed allocator.
+ *
+ * \param size size_t The number of bytes to allocate.
+ * \return void* A pointer to the allocated memory or NULL if it could not be allocated.
+ *
+ */
+void* string_mem_calloc(size_t size)
+{
+    void* block = string_mem_alloc(size);
+
+    if (block != NULL)
+        memset(block, 0, size);
+
+    return block;
+}
+
+/** \brief Resizes memory through the installed allocator.
+ *
+ * \param block void* A pointer to memory allocated by string_mem_alloc() or string_mem_realloc().
+ * \param old_size size_t The number of bytes currently allocated at block.
+ * \param new_size size_t The number of bytes required.
+ * \return void* A pointer to the resized memory or NULL--leaving block untouched--if it could not be resized.
+ *
+ */
+void* string_mem_realloc(void* block, size_t old_size, size_t new_size)
+{
+    void* new_block = realloc_hook(block, new_size, hook_context);
+
+    if (new_block != NULL)
+    {
+        STRING_ATOMIC_ADD(alloc_stats.reallocations, 1);
+        STRING_ATOMIC_ADD(alloc_stats.bytes_requested, new_size);
+
+        if (new_size > old_size)
+            string_stats_add_live(new_size - old_size);
+        else
+            STRING_ATOMIC_SUB(alloc_stats.bytes_live, old_size - new_size);
+    }
+
+    return new_block;
+}
+
+/** \brief Frees memory through the installed allocator.
+ *
+ * \param block void* A pointer to memory allocated by string_mem_alloc() or string_mem_realloc().
+ * \param size size_t The number of bytes allocated at block.
+ * \return void Nothing.
+ *
+ */
+void string_mem_free(void* block, size_t size)
+{
+    if (block != NULL)
+    {
+        free_hook(block, hook_context);
+        STRING_ATOMIC_ADD(alloc_stats.frees, 1);
+        STRING_ATOMIC_SUB(alloc_stats.bytes_live, size);
+    }
+}
@@ -0,0 +1,278 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Region allocator that lets many string objects be created and released together.
+* Filename: StringArena.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#define ARENA_ALIGNMENT 16 /* every allocation is aligned for any string_t member */
+
+typedef struct string_arena_block_t
+{
+    struct string_arena_block_t* next;
+    size_t size; /* number of usable bytes in data */
+    size_t used; /* number of bytes of data handed out since the block was last rewound */
+    char* data;
+} string_arena_block_t;
+
+struct string_arena_t
+{
+    string_arena_block_t* first_block;
+    string_arena_block_t* curr_block; /* the block allocations are currently bumped from */
+    size_t block_size;
+};
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string arena implementation                            *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Allocates a new, empty arena block able to hold at least min_size bytes.
+ *
+ * \param min_size size_t The smallest number of usable bytes the block must provide.
+ * \param block_size size_t The arena's preferred block size.
+ * \return string_arena_block_t* A pointer to the new block or NULL if memory could not be allocated.
+ *
+ */
+static string_arena_block_t* string_arena_new_block(size_t min_size, size_t block_size)
+{
+    string_arena_block_t* block         =   NULL;
+    size_t data_size                    =   min_size > block_size ? min_size : block_size;
+    size_t header_size                  =   (sizeof(string_arena_block_t) + ARENA_ALIGNMENT - 1)
+                                            & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    block = (string_arena_block_t*)string_mem_alloc(header_size + data_size);
+
+    if (block != NULL)
+    {
+        block->next     =   NULL;
+        block->size     =   data_size;
+        block->used     =   0;
+        block->data     =   (char*)block + header_size;
+    }
+
+    return block;
+}
+
+/** \brief Creates a new string arena.
+ *
+ * \param block_size int The size in bytes of the blocks the arena allocates from the heap.
+ * Values less than 1 select STRING_ARENA_DEFAULT_BLOCK_SIZE.
+ * \return string_arena_t* A pointer to the new arena or NULL if memory could not be allocated.
+ *
+ * String objects created in an arena with string_init_in() or string_cust_init_in() take their memory--both
+ * the object and any char array it grows into--from the arena's blocks. They are all released together with
+ * string_arena_reset() or string_arena_destroy(). An arena must not be used by more than one thread at a time.
+ */
+string_arena_t* string_arena_init(int block_size)
+{
+    string_arena_t* arena = (string_arena_t*)string_mem_alloc(sizeof(string_arena_t));
+
+    if (arena != NULL)
+    {
+        if (block_size < 1)
+            block_size = STRING_ARENA_DEFAULT_BLOCK_SIZE;
+
+        arena->block_size       =   (size_t)block_size;
+        arena->first_block      =   string_arena_new_block(arena->block_size, arena->block_size);
+        arena->curr_block       =   arena->first_block;
+
+        if (arena->first_block == NULL)
+        {
+            string_mem_free(arena, sizeof(string_arena_t));
+            arena = NULL;
+        }
+    }
+
+    return arena;
+}
+
+/** \brief Releases every string object allocated in an arena at once.
+ *
+ * \param arena string_arena_t* A pointer to the arena to reset.
+ * \return void Nothing.
+ *
+ * The arena keeps its blocks for reuse, so resetting it takes constant time. Every string object created in
+ * the arena becomes invalid and must not be used afterwards.
+ */
+void string_arena_reset(string_arena_t* arena)
+{
+    if (arena != NULL)
+    {
+        arena->curr_block           =   arena->first_block;
+        arena->curr_block->used     =   0; /* later blocks are rewound as allocation reaches them */
+    }
+}
+
+/** \brief Frees an arena and every string object allocated in it.
+ *
+ * \param arena string_arena_t* A pointer to the arena to free.
+ * \return void Nothing.
+ *
+ */
+void string_arena_destroy(string_arena_t* arena)
+{
+    string_arena_block_t* block;
+    string_arena_block_t* next_block;
+
+    if (arena != NULL)
+    {
+        for (block = arena->first_block; block != NULL; block = next_block)
+        {
+            next_block = block->next;
+            string_mem_free(block, (size_t)(block->data - (char*)block) + block->size);
+        }
+
+        string_mem_free(arena, sizeof(string_arena_t));
+    }
+}
+
+/** \brief Bump-allocates a block of memory from an arena.
+ *
+ * \param arena string_arena_t* A pointer to the arena to allocate from.
+ * \param size size_t The number of bytes to allocate.
+ * \return void* A pointer to the allocated memory or NULL if it could not be allocated.
+ *
+ * Blocks left over from before the last string_arena_reset() are reused before new ones are allocated.
+ */
+void* string_arena_alloc(string_arena_t* arena, size_t size)
+{
+    string_arena_block_t* block         =   arena->curr_block;
+    string_arena_block_t* new_block     =   NULL;
+    void* memory                        =   NULL;
+
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    if (block->size - block->used < size)
+    {
+        if (block->next != NULL && block->next->size >= size)
+        {
+            block           =   block->next;
+            block->used     =   0;
+        }
+        else
+        {
+            new_block = string_arena_new_block(size, arena->block_size);
+
+            if (new_block != NULL)
+            {
+                new_block->next     =   block->next;
+                block->next         =   new_block;
+            }
+
+            block = new_block;
+        }
+
+        if (block != NULL)
+            arena->curr_block = block;
+    }
+
+    if (block != NULL)
+    {
+        memory          =   block->data + block->used;
+        block->used     +=  size;
+    }
+
+    return memory;
+}
+
+/** \brief Grows a block of memory previously allocated from an arena.
+ *
+ * \param arena string_arena_t* A pointer to the arena the memory belongs to.
+ * \param block void* A pointer to the memory to grow.
+ * \param old_size size_t The number of bytes currently allocated at block.
+ * \param new_size size_t The number of bytes required.
+ * \return void* A pointer to the grown memory or NULL if it could not be allocated.
+ *
+ * If block is the most recent allocation in the current arena block it is extended in place.
+ * Otherwise new memory is allocated and the old contents are copied into it.
+ */
+void* string_arena_realloc(string_arena_t* arena, void* block, size_t old_size, size_t new_size)
+{
+    string_arena_block_t* curr_block    =   arena->curr_block;
+    void* memory                        =   NULL;
+    size_t aligned_old_size             =   (old_size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    size_t aligned_new_size             =   (new_size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    if ((char*)block + aligned_old_size == curr_block->data + curr_block->used
+        && curr_block->size - (curr_block->used - aligned_old_size) >= aligned_new_size)
+    {
+        curr_block->used    =   curr_block->used - aligned_old_size + aligned_new_size;
+        memory              =   block;
+    }
+    else
+    {
+        memory = string_arena_alloc(arena, new_size);
+
+        if (memory != NULL)
+            memcpy(memory, block, old_size < new_size ? old_size : new_size);
+    }
+
+    return memory;
+}
+
+/** \brief Creates a new, empty string object inside an arena.
+ *
+ * \param arena string_arena_t* A pointer to the arena to allocate the string object from.
+ * \return string_t* A pointer to the new string object or NULL if it could not be allocated.
+ *
+ * The string object behaves like one returned by string_init() but its memory belongs to the arena:
+ * growing it takes memory from the arena and string_destroy() leaves it to be released with the arena.
+ */
+string_t* string_init_in(string_arena_t* arena)
+{
+    return string_cust_init_in(arena, STRING_INLINE_CAPACITY);
+}
+
+/** \brief Creates a new string object of a custom initial capacity inside an arena.
+ *
+ * \param arena string_arena_t* A pointer to the arena to allocate the string object from.
+ * \param initial_size int Initial capacity of the string.
+ * \return string_t* A pointer to the new string object or NULL if it could not be allocated.
+ *
+ */
+string_t* string_cust_init_in(string_arena_t* arena, int initial_size)
+{
+    string_t* str = NULL;
+
+    if (arena != NULL && initial_size > 0)
+    {
+        str = (string_t*)string_arena_alloc(arena, string_object_size(STRING_INLINE_CAPACITY));
+
+        if (str != NULL)
+        {
+            memset(str, 0, string_object_size(STRING_INLINE_CAPACITY));
+            str->arena              =   arena;
+            str->inline_capacity    =   STRING_INLINE_CAPACITY;
+
+            if (initial_size <= STRING_INLINE_CAPACITY)
+            {
+                str->char_array     =   str->inline_buffer;
+                str->capacity       =   STRING_INLINE_CAPACITY;
+            }
+            else
+            {
+                str->char_array = (char*)string_arena_alloc(arena, initial_size);
+
+                if (str->char_array != NULL)
+                {
+                    str->char_array[0]  =   '\0';
+                    str->capacity       =   initial_size;
+                }
+                else
+                {
+                    str = NULL; /* the header stays in the arena until it is reset */
+                }
+            }
+        }
+    }
+
+    return str;
+}
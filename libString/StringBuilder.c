@@ -0,0 +1,418 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Builds strings from many pieces without ever moving what has already been appended.
+* Filename: StringBuilder.c */
+
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#define BUILDER_WRITE(fd, chars, count) (_write((fd), (chars), (unsigned int)(count)))
+#else
+#include <unistd.h>
+#define BUILDER_WRITE(fd, chars, count) (write((fd), (chars), (size_t)(count)))
+#endif
+
+typedef struct string_builder_chunk_t
+{
+    struct string_builder_chunk_t* next;
+    int size; /* number of bytes in chars */
+    int used; /* number of bytes of chars holding appended text since the chunk was last rewound */
+    char chars[];
+} string_builder_chunk_t;
+
+struct string_builder_t
+{
+    string_builder_chunk_t* first_chunk;
+    string_builder_chunk_t* curr_chunk; /* the chunk text is currently appended to */
+    int length; /* number of chars appended since the builder was created or last reset */
+    int chunk_size;
+};
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string builder implementation                          *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Allocates a new, empty builder chunk.
+ *
+ * \param size int The number of bytes the chunk can hold.
+ * \return string_builder_chunk_t* A pointer to the new chunk or NULL if memory could not be allocated.
+ *
+ */
+static string_builder_chunk_t* builder_new_chunk(int size)
+{
+    string_builder_chunk_t* chunk = (string_builder_chunk_t*)string_mem_alloc(offsetof(string_builder_chunk_t, chars)
+                                                                              + size);
+
+    if (chunk != NULL)
+    {
+        chunk->next     =   NULL;
+        chunk->size     =   size;
+        chunk->used     =   0;
+    }
+
+    return chunk;
+}
+
+/** \brief Copies characters to the end of the builder's text.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \param chars const char* The characters to append.
+ * \param length int Number of characters to append.
+ * \return int A Boolean value indicating whether or not all of the characters were appended.
+ *
+ * Fills the current chunk and continues in the next one, reusing chunks left over from before the last
+ * string_builder_reset() before allocating new ones. New chunks hold at least the rest of the characters, so a
+ * single append never needs more than one allocation. Nothing is appended if memory runs out.
+ */
+static int builder_append_chars(string_builder_t* builder, const char* chars, int length)
+{
+    string_builder_chunk_t* chunk   =   builder->curr_chunk;
+    string_builder_chunk_t* next_chunk;
+    int count;
+
+    if (length > INT_MAX - builder->length)
+        return 0;
+
+    /* make sure the chunks after the current one can take whatever does not fit in it, before copying anything */
+    if (chunk->size - chunk->used < length)
+    {
+        count = length - (chunk->size - chunk->used);
+
+        if (chunk->next == NULL || chunk->next->size < count)
+        {
+            next_chunk = builder_new_chunk(count > builder->chunk_size ? count : builder->chunk_size);
+
+            if (next_chunk == NULL)
+                return 0;
+
+            next_chunk->next    =   chunk->next;
+            chunk->next         =   next_chunk;
+        }
+
+        chunk->next->used = 0; /* a reused chunk is rewound as appending reaches it */
+    }
+
+    builder->length += length;
+
+    while (length > 0)
+    {
+        if (chunk->used == chunk->size)
+            chunk = chunk->next;
+
+        count = chunk->size - chunk->used < length ? chunk->size - chunk->used : length;
+        memcpy(chunk->chars + chunk->used, chars, count);
+        chunk->used     +=  count;
+        chars           +=  count;
+        length          -=  count;
+    }
+
+    builder->curr_chunk = chunk;
+
+    return 1;
+}
+
+/** \brief Creates a new string builder with chunks of the default size.
+ *
+ * \return string_builder_t* A pointer to the new builder or NULL if memory could not be allocated.
+ *
+ */
+string_builder_t* string_builder_init(void)
+{
+    return string_builder_cust_init(STRING_BUILDER_DEFAULT_CHUNK_SIZE);
+}
+
+/** \brief Creates a new string builder.
+ *
+ * \param chunk_size int The size in bytes of the chunks the builder allocates.
+ * Values less than 1 select STRING_BUILDER_DEFAULT_CHUNK_SIZE.
+ * \return string_builder_t* A pointer to the new builder or NULL if memory could not be allocated.
+ *
+ * A builder collects appended text in a chain of chunks and never moves what it already holds, so building a
+ * string of n characters takes O(n) time however many pieces it is made of. A builder must not be used by more
+ * than one thread at a time.
+ */
+string_builder_t* string_builder_cust_init(int chunk_size)
+{
+    string_builder_t* builder = (string_builder_t*)string_mem_alloc(sizeof(string_builder_t));
+
+    if (builder != NULL)
+    {
+        if (chunk_size < 1)
+            chunk_size = STRING_BUILDER_DEFAULT_CHUNK_SIZE;
+
+        builder->chunk_size     =   chunk_size;
+        builder->length         =   0;
+        builder->first_chunk    =   builder_new_chunk(chunk_size);
+        builder->curr_chunk     =   builder->first_chunk;
+
+        if (builder->first_chunk == NULL)
+        {
+            string_mem_free(builder, sizeof(string_builder_t));
+            builder = NULL;
+        }
+    }
+
+    return builder;
+}
+
+/** \brief Discards the builder's text so that it can be used again.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \return void Nothing.
+ *
+ * The builder keeps its chunks for reuse, so resetting it takes constant time.
+ */
+void string_builder_reset(string_builder_t* builder)
+{
+    if (builder != NULL)
+    {
+        builder->curr_chunk         =   builder->first_chunk;
+        builder->curr_chunk->used   =   0;
+        builder->length             =   0;
+    }
+}
+
+/** \brief Frees a string builder and all of its chunks.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \return void Nothing.
+ *
+ */
+void string_builder_destroy(string_builder_t* builder)
+{
+    string_builder_chunk_t* chunk;
+    string_builder_chunk_t* next_chunk;
+
+    if (builder != NULL)
+    {
+        for (chunk = builder->first_chunk; chunk != NULL; chunk = next_chunk)
+        {
+            next_chunk = chunk->next;
+            string_mem_free(chunk, offsetof(string_builder_chunk_t, chars) + chunk->size);
+        }
+
+        string_mem_free(builder, sizeof(string_builder_t));
+    }
+}
+
+/** \brief Returns the number of characters appended to the builder.
+ *
+ * \param builder const string_builder_t* A pointer to the builder.
+ * \return int The length of the builder's text, or 0 if builder is NULL.
+ *
+ */
+int string_builder_length(const string_builder_t* builder)
+{
+    return builder != NULL ? builder->length : 0;
+}
+
+/** \brief Appends a C string to the builder.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \param cstr const char* The C string to append.
+ * \return int A Boolean value indicating whether or not the C string was appended.
+ *
+ */
+int string_builder_append_cstr(string_builder_t* builder, const char* cstr)
+{
+    int bool_appended = 0;
+
+    if (builder != NULL && cstr != NULL)
+        bool_appended = builder_append_chars(builder, cstr, (int)strlen(cstr));
+
+    return bool_appended;
+}
+
+/** \brief Appends the contents of a string object to the builder.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \param str const string_t* A pointer to the string object to append.
+ * \return int A Boolean value indicating whether or not the string object was appended.
+ *
+ */
+int string_builder_append_string(string_builder_t* builder, const string_t* str)
+{
+    int bool_appended = 0;
+
+    if (builder != NULL && str != NULL)
+        bool_appended = builder_append_chars(builder, str->char_array, str->length);
+
+    return bool_appended;
+}
+
+/** \brief Appends the characters of a view to the builder.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \param view string_view_t The view to append.
+ * \return int A Boolean value indicating whether or not the view was appended.
+ *
+ */
+int string_builder_append_view(string_builder_t* builder, string_view_t view)
+{
+    int bool_appended = 0;
+
+    if (builder != NULL && view.chars != NULL)
+        bool_appended = builder_append_chars(builder, view.chars, view.length);
+
+    return bool_appended;
+}
+
+/** \brief Appends a single character to the builder.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \param character char The character to append.
+ * \return int A Boolean value indicating whether or not the character was appended.
+ *
+ */
+int string_builder_append_char(string_builder_t* builder, char character)
+{
+    int bool_appended = 0;
+
+    if (builder != NULL)
+        bool_appended = builder_append_chars(builder, &character, 1);
+
+    return bool_appended;
+}
+
+/** \brief Appends the decimal representation of an integer to the builder.
+ *
+ * \param builder string_builder_t* A pointer to the builder.
+ * \param value long long The integer to append.
+ * \return int A Boolean value indicating whether or not the integer was appended.
+ *
+ */
+int string_builder_append_int(string_builder_t* builder, long long value)
+{
+    char digits[24];
+    char* first_digit                   =   digits + sizeof(digits);
+    unsigned long long magnitude        =   value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    int bool_appended                   =   0;
+
+    if (builder != NULL)
+    {
+        do
+        {
+            *--first_digit  =   (char)('0' + magnitude % 10);
+            magnitude       /=  10;
+        } while (magnitude != 0);
+
+        if (value < 0)
+            *--first_digit = '-';
+
+        bool_appended = builder_append_chars(builder, first_digit, (int)(digits + sizeof(digits) - first_digit));
+    }
+
+    return bool_appended;
+}
+
+/** \brief Copies the builder's text into a new string object.
+ *
+ * \param builder const string_builder_t* A pointer to the builder.
+ * \return string_t* A pointer to the new string object, or NULL if builder is NULL or memory could not be allocated.
+ *
+ * The string object is made with string_flat_init(), so it takes exactly one allocation, sized to fit the text.
+ * The builder is left unchanged.
+ */
+string_t* string_builder_to_string(const string_builder_t* builder)
+{
+    const string_builder_chunk_t* chunk;
+    string_t* str = NULL;
+
+    if (builder != NULL)
+    {
+        str = string_flat_init(builder->length + 1);
+
+        if (str != NULL)
+        {
+            for (chunk = builder->first_chunk; str->length < builder->length; chunk = chunk->next)
+            {
+                memcpy(str->char_array + str->length, chunk->chars, chunk->used);
+                str->length += chunk->used;
+            }
+
+            str->char_array[str->length] = '\0';
+        }
+    }
+
+    return str;
+}
+
+/** \brief Writes the builder's text to a stream without building a string first.
+ *
+ * \param builder const string_builder_t* A pointer to the builder.
+ * \param strm FILE* The stream to write to.
+ * \return int A Boolean value indicating whether or not all of the text was written.
+ *
+ */
+int string_builder_write(const string_builder_t* builder, FILE* strm)
+{
+    const string_builder_chunk_t* chunk;
+    int written         =   0;
+    int bool_written    =   0;
+
+    if (builder != NULL && strm != NULL)
+    {
+        for (chunk = builder->first_chunk; written < builder->length; chunk = chunk->next)
+        {
+            if (fwrite(chunk->chars, 1, chunk->used, strm) != (size_t)chunk->used)
+                break;
+
+            written += chunk->used;
+        }
+
+        bool_written = written == builder->length;
+    }
+
+    return bool_written;
+}
+
+/** \brief Writes the builder's text to a file descriptor without building a string first.
+ *
+ * \param builder const string_builder_t* A pointer to the builder.
+ * \param fd int The file descriptor to write to.
+ * \return int A Boolean value indicating whether or not all of the text was written.
+ *
+ * Partial writes and writes interrupted by a signal are continued.
+ */
+int string_builder_write_fd(const string_builder_t* builder, int fd)
+{
+    const string_builder_chunk_t* chunk;
+    int written         =   0;
+    int chunk_written, count;
+    int bool_failed     =   0;
+
+    if (builder == NULL || fd < 0)
+        return 0;
+
+    for (chunk = builder->first_chunk; !bool_failed && written < builder->length; chunk = chunk->next)
+    {
+        chunk_written = 0;
+
+        while (!bool_failed && chunk_written < chunk->used)
+        {
+            count = (int)BUILDER_WRITE(fd, chunk->chars + chunk_written, chunk->used - chunk_written);
+
+            if (count > 0)
+                chunk_written += count;
+            else if (count < 0 && errno == EINTR)
+                continue;
+            else
+                bool_failed = 1;
+        }
+
+        written += chunk_written;
+    }
+
+    return !bool_failed;
+}
@@ -0,0 +1,410 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Vectorized ASCII case conversion, and case-insensitive comparison and hashing.
+* Filename: StringCase.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CASE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* Like the search kernels, the AVX2 kernels are compiled for their own target and picked at run time. */
+#if defined(CASE_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ >= 5)
+#define CASE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#define CASE_ONES 0x0101010101010101ULL
+#define CASE_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string case implementation                             *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Converts the case of a run of characters one byte at a time.
+ *
+ * \param dest char* Where to write the converted characters--may be source itself.
+ * \param source const char* The characters to convert.
+ * \param length int Number of characters to convert.
+ * \param bool_upper int A Boolean value; when true lowercase letters are made uppercase, otherwise the reverse.
+ * \return void Nothing.
+ *
+ * Letters of the other case have bit 0x20 flipped; every other byte--including bytes outside ASCII--is copied.
+ */
+static void case_map_scalar(char* dest, const char* source, int length, int bool_upper)
+{
+    const unsigned char first_letter    =   bool_upper ? 'a' : 'A';
+    unsigned char character;
+    int pos;
+
+    for (pos = 0; pos < length; pos++)
+    {
+        character   =   (unsigned char)source[pos];
+        dest[pos]   =   (char)(character ^ ((unsigned char)(character - first_letter) < 26 ? 0x20 : 0));
+    }
+}
+
+/** \brief Folds the uppercase ASCII letters of the eight bytes packed in a word to lowercase.
+ *
+ * \param word unsigned long long The bytes.
+ * \return unsigned long long The bytes with 'A' to 'Z' replaced by 'a' to 'z'.
+ *
+ * Adding 0x3f to a byte below 0x80 sets its top bit from 'A' upwards, and adding 0x25 sets it past 'Z', so the two
+ * sums differ in the top bit exactly for the uppercase letters. Neither sum carries into the next byte.
+ */
+static unsigned long long case_fold_word(unsigned long long word)
+{
+    unsigned long long low_bits     =   word & (0x7f * CASE_ONES);
+    unsigned long long uppercase    =   ((low_bits + 0x3f * CASE_ONES) ^ (low_bits + 0x25 * CASE_ONES)) & ~word
+                                        & (0x80 * CASE_ONES);
+
+    return word | (uppercase >> 2);
+}
+
+#if defined(CASE_SSE2)
+/** \brief Selects the bytes of a block that are letters of the case to convert.
+ *
+ * \param block __m128i The bytes.
+ * \param offset __m128i 0x80 minus the first letter of the case, in every byte.
+ * \return __m128i 0x20 in the bytes to convert, 0 elsewhere.
+ *
+ * Shifting the letters down to the bottom of the signed range turns the range check into a single compare.
+ */
+static __m128i case_flip_bits_sse2(__m128i block, __m128i offset)
+{
+    const __m128i limit     =   _mm_set1_epi8((char)(-128 + 26));
+
+    return _mm_and_si128(_mm_cmpgt_epi8(limit, _mm_add_epi8(block, offset)), _mm_set1_epi8(0x20));
+}
+
+/** \brief Converts the case of a run of characters 16 bytes at a time with SSE2.
+ *
+ * \param dest char* Where to write the converted characters--may be source itself.
+ * \param source const char* The characters to convert.
+ * \param length int Number of characters to convert.
+ * \param bool_upper int A Boolean value; when true lowercase letters are made uppercase, otherwise the reverse.
+ * \return void Nothing.
+ *
+ */
+static void case_map_sse2(char* dest, const char* source, int length, int bool_upper)
+{
+    const __m128i offset    =   _mm_set1_epi8((char)(0x80 - (bool_upper ? 'a' : 'A')));
+    __m128i block;
+    int pos;
+
+    for (pos = 0; pos + 16 <= length; pos += 16)
+    {
+        block = _mm_loadu_si128((const __m128i*)(source + pos));
+        _mm_storeu_si128((__m128i*)(dest + pos), _mm_xor_si128(block, case_flip_bits_sse2(block, offset)));
+    }
+
+    case_map_scalar(dest + pos, source + pos, length - pos, bool_upper);
+}
+
+/** \brief Compares two runs of characters ignoring ASCII case, 16 bytes at a time with SSE2.
+ *
+ * \param chars1 const char* The first characters.
+ * \param chars2 const char* The second characters.
+ * \param length int Number of characters to compare.
+ * \return int The number of leading bytes compared equal: a multiple of 16, length if all compared equal.
+ *
+ */
+static int case_equal_prefix_sse2(const char* chars1, const char* chars2, int length)
+{
+    const __m128i offset    =   _mm_set1_epi8((char)(0x80 - 'A'));
+    __m128i block1, block2;
+    int pos;
+
+    for (pos = 0; pos + 16 <= length; pos += 16)
+    {
+        block1  =   _mm_loadu_si128((const __m128i*)(chars1 + pos));
+        block2  =   _mm_loadu_si128((const __m128i*)(chars2 + pos));
+        block1  =   _mm_or_si128(block1, case_flip_bits_sse2(block1, offset));
+        block2  =   _mm_or_si128(block2, case_flip_bits_sse2(block2, offset));
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block1, block2)) != 0xffff)
+            return pos;
+    }
+
+    return pos;
+}
+#endif
+
+#if defined(CASE_AVX2)
+/** \brief Selects the bytes of a block that are letters of the case to convert.
+ *
+ * \param block __m256i The bytes.
+ * \param offset __m256i 0x80 minus the first letter of the case, in every byte.
+ * \return __m256i 0x20 in the bytes to convert, 0 elsewhere.
+ *
+ */
+__attribute__((target("avx2")))
+static __m256i case_flip_bits_avx2(__m256i block, __m256i offset)
+{
+    const __m256i limit     =   _mm256_set1_epi8((char)(-128 + 26));
+
+    return _mm256_and_si256(_mm256_cmpgt_epi8(limit, _mm256_add_epi8(block, offset)), _mm256_set1_epi8(0x20));
+}
+
+/** \brief Converts the case of a run of characters 64 bytes at a time with AVX2.
+ *
+ * \param dest char* Where to write the converted characters--may be source itself.
+ * \param source const char* The characters to convert.
+ * \param length int Number of characters to convert.
+ * \param bool_upper int A Boolean value; when true lowercase letters are made uppercase, otherwise the reverse.
+ * \return void Nothing.
+ *
+ */
+__attribute__((target("avx2")))
+static void case_map_avx2(char* dest, const char* source, int length, int bool_upper)
+{
+    const __m256i offset    =   _mm256_set1_epi8((char)(0x80 - (bool_upper ? 'a' : 'A')));
+    __m256i block_low, block_high;
+    int pos;
+
+    for (pos = 0; pos + 64 <= length; pos += 64)
+    {
+        block_low   =   _mm256_loadu_si256((const __m256i*)(source + pos));
+        block_high  =   _mm256_loadu_si256((const __m256i*)(source + pos + 32));
+        _mm256_storeu_si256((__m256i*)(dest + pos),
+                            _mm256_xor_si256(block_low, case_flip_bits_avx2(block_low, offset)));
+        _mm256_storeu_si256((__m256i*)(dest + pos + 32),
+                            _mm256_xor_si256(block_high, case_flip_bits_avx2(block_high, offset)));
+    }
+
+    case_map_sse2(dest + pos, source + pos, length - pos, bool_upper);
+}
+
+/** \brief Compares two runs of characters ignoring ASCII case, 32 bytes at a time with AVX2.
+ *
+ * \param chars1 const char* The first characters.
+ * \param chars2 const char* The second characters.
+ * \param length int Number of characters to compare.
+ * \return int The number of leading bytes compared equal: a multiple of 16, length if all compared equal.
+ *
+ */
+__attribute__((target("avx2")))
+static int case_equal_prefix_avx2(const char* chars1, const char* chars2, int length)
+{
+    const __m256i offset    =   _mm256_set1_epi8((char)(0x80 - 'A'));
+    __m256i block1, block2;
+    int pos;
+
+    for (pos = 0; pos + 32 <= length; pos += 32)
+    {
+        block1  =   _mm256_loadu_si256((const __m256i*)(chars1 + pos));
+        block2  =   _mm256_loadu_si256((const __m256i*)(chars2 + pos));
+        block1  =   _mm256_or_si256(block1, case_flip_bits_avx2(block1, offset));
+        block2  =   _mm256_or_si256(block2, case_flip_bits_avx2(block2, offset));
+
+        if ((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block1, block2)) != 0xffffffffu)
+            return pos;
+    }
+
+    return pos + case_equal_prefix_sse2(chars1 + pos, chars2 + pos, length - pos);
+}
+#endif
+
+/** \brief Converts the ASCII letters of a run of characters to one case.
+ *
+ * \param dest char* Where to write the converted characters--may be source itself, but must not overlap it otherwise.
+ * \param source const char* The characters to convert.
+ * \param length int Number of characters to convert.
+ * \param bool_upper int A Boolean value; when true lowercase letters are made uppercase, otherwise the reverse.
+ * \return void Nothing.
+ *
+ * Uses the widest vector kernel the CPU supports. No terminating null character is written.
+ */
+void string_case_map(char* dest, const char* source, int length, int bool_upper)
+{
+#if defined(CASE_AVX2)
+    if (length >= 64 && __builtin_cpu_supports("avx2"))
+        case_map_avx2(dest, source, length, bool_upper);
+    else
+        case_map_sse2(dest, source, length, bool_upper);
+#elif defined(CASE_SSE2)
+    case_map_sse2(dest, source, length, bool_upper);
+#else
+    case_map_scalar(dest, source, length, bool_upper);
+#endif
+}
+
+/** \brief Tests whether two views hold the same characters, ignoring the case of ASCII letters.
+ *
+ * \param view1 string_view_t The first view.
+ * \param view2 string_view_t The second view.
+ * \return int A Boolean value, 0 for False and 1 for True. Two NULL views are equal; a NULL view equals no other.
+ *
+ * Bytes outside ASCII must match exactly. Views of different lengths are told apart without reading them.
+ */
+int string_view_equal_ci(string_view_t view1, string_view_t view2)
+{
+    int pos = 0;
+
+    if (view1.chars == NULL || view2.chars == NULL)
+        return view1.chars == view2.chars;
+
+    if (view1.length != view2.length)
+        return 0;
+
+#if defined(CASE_AVX2)
+    if (view1.length >= 32 && __builtin_cpu_supports("avx2"))
+        pos = case_equal_prefix_avx2(view1.chars, view2.chars, view1.length);
+    else
+        pos = case_equal_prefix_sse2(view1.chars, view2.chars, view1.length);
+#elif defined(CASE_SSE2)
+    pos = case_equal_prefix_sse2(view1.chars, view2.chars, view1.length);
+#endif
+
+    /* finish the tail, or find the differing byte of the block that stopped the vector kernel */
+    for (; pos < view1.length; pos++)
+    {
+        if (view1.chars[pos] != view2.chars[pos]
+            && (((unsigned char)view1.chars[pos] | 0x20) != ((unsigned char)view2.chars[pos] | 0x20)
+                || (unsigned char)(((unsigned char)view1.chars[pos] | 0x20) - 'a') >= 26))
+            return 0;
+    }
+
+    return 1;
+}
+
+/** \brief Compares two views in lexicographical order, ignoring the case of ASCII letters.
+ *
+ * \param view1 string_view_t The first view.
+ * \param view2 string_view_t The second view.
+ * \return int A value less than, equal to or greater than 0 as view1 sorts before, the same as or after view2.
+ *
+ * Uppercase ASCII letters compare as their lowercase forms and every other byte as its unsigned value, so the order
+ * agrees with string_view_compare() on strings without uppercase letters. A NULL view sorts before every other view.
+ */
+int string_view_compare_ci(string_view_t view1, string_view_t view2)
+{
+    int common_length, pos = 0;
+    int char1, char2;
+
+    if (view1.chars == NULL || view2.chars == NULL)
+        return (view1.chars != NULL) - (view2.chars != NULL);
+
+    common_length = view1.length < view2.length ? view1.length : view2.length;
+
+#if defined(CASE_AVX2)
+    if (common_length >= 32 && __builtin_cpu_supports("avx2"))
+        pos = case_equal_prefix_avx2(view1.chars, view2.chars, common_length);
+    else
+        pos = case_equal_prefix_sse2(view1.chars, view2.chars, common_length);
+#elif defined(CASE_SSE2)
+    pos = case_equal_prefix_sse2(view1.chars, view2.chars, common_length);
+#endif
+
+    /* finish the tail, or find the differing byte of the block that stopped the vector kernel */
+    for (; pos < common_length; pos++)
+    {
+        char1   =   (unsigned char)view1.chars[pos];
+        char2   =   (unsigned char)view2.chars[pos];
+
+        if (char1 != char2)
+        {
+            if (char1 >= 'A' && char1 <= 'Z')
+                char1 |= 0x20;
+            if (char2 >= 'A' && char2 <= 'Z')
+                char2 |= 0x20;
+            if (char1 != char2)
+                return char1 - char2;
+        }
+    }
+
+    return (view1.length > view2.length) - (view1.length < view2.length);
+}
+
+/** \brief Tests whether two string objects hold the same characters, ignoring the case of ASCII letters.
+ *
+ * \param str1 const string_t* A pointer to the first string object.
+ * \param str2 const string_t* A pointer to the second string object.
+ * \return int A Boolean value, 0 for False and 1 for True.
+ *
+ * See string_view_equal_ci().
+ */
+int string_equal_ci(const string_t* str1, const string_t* str2)
+{
+    return string_view_equal_ci(string_view_from_string(str1), string_view_from_string(str2));
+}
+
+/** \brief Compares two string objects in lexicographical order, ignoring the case of ASCII letters.
+ *
+ * \param str1 const string_t* A pointer to the first string object.
+ * \param str2 const string_t* A pointer to the second string object.
+ * \return int A value less than, equal to or greater than 0 as str1 sorts before, the same as or after str2.
+ *
+ * See string_view_compare_ci().
+ */
+int string_compare_ci(const string_t* str1, const string_t* str2)
+{
+    return string_view_compare_ci(string_view_from_string(str1), string_view_from_string(str2));
+}
+
+/** \brief Hashes the characters of a view with the case of ASCII letters folded away.
+ *
+ * \param view string_view_t The view to hash.
+ * \return unsigned long long The 64-bit hash. Views that string_view_equal_ci() finds equal hash the same.
+ *
+ * Eight characters are folded to lowercase and mixed in per step. The hash is meant for hash tables: it is well
+ * distributed but not cryptographic, and its values may differ between platforms of different byte order.
+ */
+unsigned long long string_view_hash_ci(string_view_t view)
+{
+    unsigned long long hash     =   CASE_HASH_MULTIPLIER;
+    unsigned long long word;
+    int pos                     =   0;
+
+    if (view.chars != NULL)
+    {
+        hash ^= (unsigned long long)view.length * CASE_HASH_MULTIPLIER;
+
+        for (; pos + 8 <= view.length; pos += 8)
+        {
+            memcpy(&word, view.chars + pos, 8);
+            hash    =   (hash ^ case_fold_word(word)) * CASE_HASH_MULTIPLIER;
+            hash    ^=  hash >> 32;
+        }
+
+        if (pos < view.length)
+        {
+            word = 0;
+            memcpy(&word, view.chars + pos, view.length - pos);
+            hash    =   (hash ^ case_fold_word(word)) * CASE_HASH_MULTIPLIER;
+            hash    ^=  hash >> 32;
+        }
+    }
+
+    /* the 64-bit finalizer of MurmurHash3, so that every input bit affects every output bit */
+    hash    ^=  hash >> 33;
+    hash    *=  0xff51afd7ed558ccdULL;
+    hash    ^=  hash >> 33;
+    hash    *=  0xc4ceb9fe1a85ec53ULL;
+    hash    ^=  hash >> 33;
+
+    return hash;
+}
+
+/** \brief Hashes the characters of a string object with the case of ASCII letters folded away.
+ *
+ * \param str const string_t* A pointer to the string object to hash.
+ * \return unsigned long long The 64-bit hash. String objects that string_equal_ci() finds equal hash the same.
+ *
+ * See string_view_hash_ci().
+ */
+unsigned long long string_hash_ci(const string_t* str)
+{
+    return string_view_hash_ci(string_view_from_string(str));
+}
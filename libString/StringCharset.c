@@ -0,0 +1,832 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Sets of byte values, and a vectorized engine that checks runs of characters against them.
+* Filename: StringCharset.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+/* The nibble lookups need SSSE3's byte shuffle, so both kernels are compiled for their own target and only used
+   when the CPU running the program supports it. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || __GNUC__ >= 5)
+#define CHARSET_SSSE3 1
+#define CHARSET_AVX2 1
+#include <immintrin.h>
+#endif
+
+/* The character classes of the C locale, in the layout described at string_charset_t. */
+static const string_charset_t charset_classes[STRING_CLASS_COUNT] =
+{
+    /* STRING_CLASS_ALPHA: A-Z and a-z */
+    {{0xa0, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0, 0xf0, 0x50, 0x50, 0x50, 0x50, 0x50,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_DIGIT: 0-9 */
+    {{0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_ALPHANUM: A-Z, a-z and 0-9 */
+    {{0xa8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf8, 0xf0, 0x50, 0x50, 0x50, 0x50, 0x50,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_XDIGIT: 0-9, A-F and a-f */
+    {{0x08, 0x58, 0x58, 0x58, 0x58, 0x58, 0x58, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_UPPER: A-Z */
+    {{0x20, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30, 0x10, 0x10, 0x10, 0x10, 0x10,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_LOWER: a-z */
+    {{0x80, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x40, 0x40, 0x40, 0x40, 0x40,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_SPACE: space, \t, \n, \v, \f and \r */
+    {{0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_PUNCT: the printable characters other than letters, digits and space */
+    {{0x50, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0c, 0xac, 0xac, 0xac, 0xac, 0x2c,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_CNTRL: 0-31 and 127 */
+    {{0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x83,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}},
+    /* STRING_CLASS_PRINT: 32-126 */
+    {{0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0xfc, 0x7c,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}
+};
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string charset implementation                          *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Returns the index of the lowest set bit in a non-zero mask.
+ *
+ * \param mask unsigned int The mask.
+ * \return int The index of the lowest set bit.
+ *
+ */
+static int charset_lowest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+
+    while (!(mask & 1u))
+    {
+        mask >>= 1;
+        bit++;
+    }
+
+    return bit;
+#endif
+}
+
+/** \brief Returns the index of the highest set bit in a non-zero mask.
+ *
+ * \param mask unsigned int The mask.
+ * \return int The index of the highest set bit.
+ *
+ */
+static int charset_highest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(mask);
+#else
+    int bit = 31;
+
+    while (!(mask & 0x80000000u))
+    {
+        mask <<= 1;
+        bit--;
+    }
+
+    return bit;
+#endif
+}
+
+/** \brief Scans a run of characters one byte at a time.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the first character that is not in the
+ * set, otherwise at the first character that is.
+ * \return int The index the scan stopped at, or length if it ran to the end.
+ *
+ */
+static int charset_scan_scalar(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+    int pos;
+
+    for (pos = 0; pos < length; pos++)
+    {
+        if (string_charset_contains(set, (unsigned char)chars[pos]) != bool_members)
+            break;
+    }
+
+    return pos;
+}
+
+/** \brief Scans a run of characters backwards one byte at a time.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the last character that is not in the
+ * set, otherwise at the last character that is.
+ * \return int The index the scan stopped at, or -1 if it ran to the beginning.
+ *
+ */
+static int charset_scan_reverse_scalar(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+    int pos;
+
+    for (pos = length - 1; pos >= 0; pos--)
+    {
+        if (string_charset_contains(set, (unsigned char)chars[pos]) != bool_members)
+            break;
+    }
+
+    return pos;
+}
+
+/** \brief Compacts a run of characters one byte at a time.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars char* The characters to compact in place.
+ * \param length int Number of characters.
+ * \param bool_keep int A Boolean value; when true the members of the set are kept and the others dropped,
+ * otherwise the reverse.
+ * \return int The number of characters kept.
+ *
+ * Every character is written to the next free slot, but the slot is only taken when the character is kept,
+ * so the loop does not branch on the characters.
+ */
+static int charset_compact_scalar(const string_charset_t* set, char* chars, int length, int bool_keep)
+{
+    char character;
+    int pos, kept = 0;
+
+    for (pos = 0; pos < length; pos++)
+    {
+        character       =   chars[pos];
+        chars[kept]     =   character;
+        kept            +=  string_charset_contains(set, (unsigned char)character) == bool_keep;
+    }
+
+    return kept;
+}
+
+#if defined(CHARSET_SSSE3)
+/** \brief Flags the members of a set among 16 bytes.
+ *
+ * \param block __m128i The bytes.
+ * \param rows_low __m128i The first half of the set's bits, for the bytes below 0x80.
+ * \param rows_high __m128i The second half of the set's bits, for the bytes from 0x80 up.
+ * \return __m128i 0xff in the bytes that are members, 0 elsewhere.
+ *
+ * The low nibble of each byte picks a row of the set's bits and the high nibble picks a bit of that row. A shuffle
+ * index with its top bit set yields 0, so the row is looked up in both halves, each seeing only its own bytes.
+ */
+__attribute__((target("ssse3")))
+static __m128i charset_members_ssse3(__m128i block, __m128i rows_low, __m128i rows_high)
+{
+    const __m128i row_index     =   _mm_and_si128(block, _mm_set1_epi8((char)0x8f));
+    const __m128i bit_of_nibble =   _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128,
+                                                  1, 2, 4, 8, 16, 32, 64, (char)128);
+    __m128i row, bit;
+
+    row     =   _mm_or_si128(_mm_shuffle_epi8(rows_low, row_index),
+                             _mm_shuffle_epi8(rows_high, _mm_xor_si128(row_index, _mm_set1_epi8((char)0x80))));
+    bit     =   _mm_shuffle_epi8(bit_of_nibble, _mm_and_si128(_mm_srli_epi16(block, 4), _mm_set1_epi8(0x0f)));
+
+    return _mm_cmpeq_epi8(_mm_and_si128(row, bit), bit);
+}
+
+/** \brief Scans a run of characters 16 bytes at a time with SSSE3.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the first character that is not in the
+ * set, otherwise at the first character that is.
+ * \return int The index the scan stopped at, or length if it ran to the end.
+ *
+ */
+__attribute__((target("ssse3")))
+static int charset_scan_ssse3(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+    const __m128i rows_low      =   _mm_loadu_si128((const __m128i*)set->bits);
+    const __m128i rows_high     =   _mm_loadu_si128((const __m128i*)(set->bits + 16));
+    const unsigned int flip     =   bool_members ? 0xffffu : 0u;
+    unsigned int mask;
+    int pos;
+
+    for (pos = 0; pos + 16 <= length; pos += 16)
+    {
+        mask = (unsigned int)_mm_movemask_epi8(charset_members_ssse3(_mm_loadu_si128((const __m128i*)(chars + pos)),
+                                                                     rows_low, rows_high)) ^ flip;
+
+        if (mask != 0)
+            return pos + charset_lowest_bit(mask);
+    }
+
+    return pos + charset_scan_scalar(set, chars + pos, length - pos, bool_members);
+}
+
+/** \brief Scans a run of characters backwards 16 bytes at a time with SSSE3.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the last character that is not in the
+ * set, otherwise at the last character that is.
+ * \return int The index the scan stopped at, or -1 if it ran to the beginning.
+ *
+ */
+__attribute__((target("ssse3")))
+static int charset_scan_reverse_ssse3(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+    const __m128i rows_low      =   _mm_loadu_si128((const __m128i*)set->bits);
+    const __m128i rows_high     =   _mm_loadu_si128((const __m128i*)(set->bits + 16));
+    const unsigned int flip     =   bool_members ? 0xffffu : 0u;
+    __m128i block;
+    unsigned int mask;
+    int end;
+
+    for (end = length; end >= 16; end -= 16)
+    {
+        block   =   _mm_loadu_si128((const __m128i*)(chars + end - 16));
+        mask    =   (unsigned int)_mm_movemask_epi8(charset_members_ssse3(block, rows_low, rows_high)) ^ flip;
+
+        if (mask != 0)
+            return end - 16 + charset_highest_bit(mask);
+    }
+
+    return charset_scan_reverse_scalar(set, chars, end, bool_members);
+}
+
+/** \brief Compacts a run of characters 16 bytes at a time with SSSE3.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars char* The characters to compact in place.
+ * \param length int Number of characters.
+ * \param bool_keep int A Boolean value; when true the members of the set are kept and the others dropped,
+ * otherwise the reverse.
+ * \return int The number of characters kept.
+ *
+ * Blocks that are kept or dropped whole cost one store or nothing; only mixed blocks are compacted byte by byte.
+ * The output never overtakes the input, so each block can be written back as soon as it has been read.
+ */
+__attribute__((target("ssse3")))
+static int charset_compact_ssse3(const string_charset_t* set, char* chars, int length, int bool_keep)
+{
+    const __m128i rows_low      =   _mm_loadu_si128((const __m128i*)set->bits);
+    const __m128i rows_high     =   _mm_loadu_si128((const __m128i*)(set->bits + 16));
+    const unsigned int flip     =   bool_keep ? 0u : 0xffffu;
+    unsigned char block_chars[16];
+    __m128i block;
+    unsigned int keep_mask;
+    int pos, bit, kept = 0;
+
+    for (pos = 0; pos + 16 <= length; pos += 16)
+    {
+        block       =   _mm_loadu_si128((const __m128i*)(chars + pos));
+        keep_mask   =   (unsigned int)_mm_movemask_epi8(charset_members_ssse3(block, rows_low, rows_high)) ^ flip;
+
+        if (keep_mask == 0xffffu)
+        {
+            _mm_storeu_si128((__m128i*)(chars + kept), block);
+            kept += 16;
+        }
+        else if (keep_mask != 0)
+        {
+            _mm_storeu_si128((__m128i*)block_chars, block);
+
+            for (bit = 0; bit < 16; bit++)
+            {
+                chars[kept]     =   (char)block_chars[bit];
+                kept            +=  (keep_mask >> bit) & 1;
+            }
+        }
+    }
+
+    memmove(chars + kept, chars + pos, length - pos);
+
+    return kept + charset_compact_scalar(set, chars + kept, length - pos, bool_keep);
+}
+#endif
+
+#if defined(CHARSET_AVX2)
+/** \brief Flags the members of a set among 32 bytes.
+ *
+ * \param block __m256i The bytes.
+ * \param rows_low __m256i The first half of the set's bits in both lanes.
+ * \param rows_high __m256i The second half of the set's bits in both lanes.
+ * \return __m256i 0xff in the bytes that are members, 0 elsewhere.
+ *
+ * See charset_members_ssse3().
+ */
+__attribute__((target("avx2")))
+static __m256i charset_members_avx2(__m256i block, __m256i rows_low, __m256i rows_high)
+{
+    const __m256i row_index     =   _mm256_and_si256(block, _mm256_set1_epi8((char)0x8f));
+    const __m256i bit_of_nibble =   _mm256_broadcastsi128_si256(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, (char)128,
+                                                                              1, 2, 4, 8, 16, 32, 64, (char)128));
+    __m256i row, bit;
+
+    row     =   _mm256_or_si256(_mm256_shuffle_epi8(rows_low, row_index),
+                                _mm256_shuffle_epi8(rows_high,
+                                                    _mm256_xor_si256(row_index, _mm256_set1_epi8((char)0x80))));
+    bit     =   _mm256_shuffle_epi8(bit_of_nibble,
+                                    _mm256_and_si256(_mm256_srli_epi16(block, 4), _mm256_set1_epi8(0x0f)));
+
+    return _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+}
+
+/** \brief Scans a run of characters 32 bytes at a time with AVX2.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the first character that is not in the
+ * set, otherwise at the first character that is.
+ * \return int The index the scan stopped at, or length if it ran to the end.
+ *
+ */
+__attribute__((target("avx2")))
+static int charset_scan_avx2(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+    const __m256i rows_low      =   _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->bits));
+    const __m256i rows_high     =   _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(set->bits + 16)));
+    const unsigned int flip     =   bool_members ? 0xffffffffu : 0u;
+    __m256i block;
+    unsigned int mask;
+    int pos;
+
+    for (pos = 0; pos + 32 <= length; pos += 32)
+    {
+        block   =   _mm256_loadu_si256((const __m256i*)(chars + pos));
+        mask    =   (unsigned int)_mm256_movemask_epi8(charset_members_avx2(block, rows_low, rows_high)) ^ flip;
+
+        if (mask != 0)
+            return pos + charset_lowest_bit(mask);
+    }
+
+    return pos + charset_scan_ssse3(set, chars + pos, length - pos, bool_members);
+}
+
+/** \brief Scans a run of characters backwards 32 bytes at a time with AVX2.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the last character that is not in the
+ * set, otherwise at the last character that is.
+ * \return int The index the scan stopped at, or -1 if it ran to the beginning.
+ *
+ */
+__attribute__((target("avx2")))
+static int charset_scan_reverse_avx2(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+    const __m256i rows_low      =   _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->bits));
+    const __m256i rows_high     =   _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(set->bits + 16)));
+    const unsigned int flip     =   bool_members ? 0xffffffffu : 0u;
+    __m256i block;
+    unsigned int mask;
+    int end;
+
+    for (end = length; end >= 32; end -= 32)
+    {
+        block   =   _mm256_loadu_si256((const __m256i*)(chars + end - 32));
+        mask    =   (unsigned int)_mm256_movemask_epi8(charset_members_avx2(block, rows_low, rows_high)) ^ flip;
+
+        if (mask != 0)
+            return end - 32 + charset_highest_bit(mask);
+    }
+
+    return charset_scan_reverse_ssse3(set, chars, end, bool_members);
+}
+
+/** \brief Compacts a run of characters 32 bytes at a time with AVX2 and BMI2.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars char* The characters to compact in place.
+ * \param length int Number of characters.
+ * \param bool_keep int A Boolean value; when true the members of the set are kept and the others dropped,
+ * otherwise the reverse.
+ * \return int The number of characters kept.
+ *
+ * Works like charset_compact_ssse3(), but mixed blocks are compacted eight bytes at a time: the keep mask is
+ * spread into a byte mask with pdep and the kept bytes are gathered to the bottom of the word with pext.
+ */
+__attribute__((target("avx2,bmi2")))
+static int charset_compact_avx2(const string_charset_t* set, char* chars, int length, int bool_keep)
+{
+    const __m256i rows_low      =   _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)set->bits));
+    const __m256i rows_high     =   _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(set->bits + 16)));
+    const unsigned int flip     =   bool_keep ? 0u : 0xffffffffu;
+    unsigned long long words[4];
+    unsigned long long packed;
+    __m256i block;
+    unsigned int keep_mask, keep_byte;
+    int pos, word, kept = 0;
+
+    for (pos = 0; pos + 32 <= length; pos += 32)
+    {
+        block       =   _mm256_loadu_si256((const __m256i*)(chars + pos));
+        keep_mask   =   (unsigned int)_mm256_movemask_epi8(charset_members_avx2(block, rows_low, rows_high)) ^ flip;
+
+        if (keep_mask == 0xffffffffu)
+        {
+            _mm256_storeu_si256((__m256i*)(chars + kept), block);
+            kept += 32;
+        }
+        else if (keep_mask != 0)
+        {
+            _mm256_storeu_si256((__m256i*)words, block);
+
+            /* each store writes 8 bytes but only advances by the kept ones; it never passes the word just read */
+            for (word = 0; word < 4; word++)
+            {
+                keep_byte   =   (keep_mask >> (word * 8)) & 0xff;
+                packed      =   _pext_u64(words[word], _pdep_u64(keep_byte, 0x0101010101010101ULL) * 0xff);
+                memcpy(chars + kept, &packed, 8);
+                kept        +=  __builtin_popcount(keep_byte);
+            }
+        }
+    }
+
+    memmove(chars + kept, chars + pos, length - pos);
+
+    return kept + charset_compact_ssse3(set, chars + kept, length - pos, bool_keep);
+}
+#endif
+
+/** \brief Scans a run of characters for the first one that is--or is not--in a set.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the first character that is not in the
+ * set, otherwise at the first character that is.
+ * \return int The index the scan stopped at, or length if it ran to the end.
+ *
+ * This is the engine behind the character class functions. It uses the widest vector kernel the CPU supports.
+ */
+int string_charset_scan(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+#if defined(CHARSET_AVX2)
+    if (length >= 32 && __builtin_cpu_supports("avx2"))
+        return charset_scan_avx2(set, chars, length, bool_members);
+
+    if (length >= 16 && __builtin_cpu_supports("ssse3"))
+        return charset_scan_ssse3(set, chars, length, bool_members);
+#endif
+
+    return charset_scan_scalar(set, chars, length, bool_members);
+}
+
+/** \brief Scans a run of characters backwards for the last one that is--or is not--in a set.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars const char* The characters to scan.
+ * \param length int Number of characters to scan.
+ * \param bool_members int A Boolean value; when true the scan stops at the last character that is not in the
+ * set, otherwise at the last character that is.
+ * \return int The index the scan stopped at, or -1 if it ran to the beginning.
+ *
+ * The mirror image of string_charset_scan().
+ */
+int string_charset_scan_reverse(const string_charset_t* set, const char* chars, int length, int bool_members)
+{
+#if defined(CHARSET_AVX2)
+    if (length >= 32 && __builtin_cpu_supports("avx2"))
+        return charset_scan_reverse_avx2(set, chars, length, bool_members);
+
+    if (length >= 16 && __builtin_cpu_supports("ssse3"))
+        return charset_scan_reverse_ssse3(set, chars, length, bool_members);
+#endif
+
+    return charset_scan_reverse_scalar(set, chars, length, bool_members);
+}
+
+/** \brief Removes the characters that are--or are not--in a set from a run of characters, in a single pass.
+ *
+ * \param set const string_charset_t* The set to check the characters against.
+ * \param chars char* The characters to compact in place.
+ * \param length int Number of characters.
+ * \param bool_keep int A Boolean value; when true the members of the set are kept and the others dropped,
+ * otherwise the reverse.
+ * \return int The number of characters kept; they are moved to the front in their original order.
+ *
+ * Uses the widest vector kernel the CPU supports. No terminating null character is written.
+ */
+int string_charset_compact(const string_charset_t* set, char* chars, int length, int bool_keep)
+{
+#if defined(CHARSET_AVX2)
+    if (length >= 32 && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2"))
+        return charset_compact_avx2(set, chars, length, bool_keep);
+
+    if (length >= 16 && __builtin_cpu_supports("ssse3"))
+        return charset_compact_ssse3(set, chars, length, bool_keep);
+#endif
+
+    return charset_compact_scalar(set, chars, length, bool_keep);
+}
+
+/** \brief Empties a character set.
+ *
+ * \param set string_charset_t* A pointer to the set.
+ * \return void Nothing.
+ *
+ */
+void string_charset_clear(string_charset_t* set)
+{
+    if (set != NULL)
+        memset(set->bits, 0, sizeof(set->bits));
+}
+
+/** \brief Adds a single character to a character set.
+ *
+ * \param set string_charset_t* A pointer to the set.
+ * \param character unsigned char The character to add.
+ * \return void Nothing.
+ *
+ */
+void string_charset_add(string_charset_t* set, unsigned char character)
+{
+    if (set != NULL)
+        set->bits[(character & 0x80 ? 16 : 0) + (character & 0x0f)] |= (unsigned char)(1u << ((character >> 4) & 7));
+}
+
+/** \brief Adds a range of characters to a character set.
+ *
+ * \param set string_charset_t* A pointer to the set.
+ * \param first unsigned char The first character of the range.
+ * \param last unsigned char The last character of the range. Nothing is added if it comes before first.
+ * \return void Nothing.
+ *
+ */
+void string_charset_add_range(string_charset_t* set, unsigned char first, unsigned char last)
+{
+    int character;
+
+    for (character = first; character <= last; character++)
+        string_charset_add(set, (unsigned char)character);
+}
+
+/** \brief Adds every character of a C string to a character set.
+ *
+ * \param set string_charset_t* A pointer to the set.
+ * \param chars const char* The characters to add.
+ * \return void Nothing.
+ *
+ */
+void string_charset_add_chars(string_charset_t* set, const char* chars)
+{
+    if (chars != NULL)
+    {
+        for (; *chars != '\0'; chars++)
+            string_charset_add(set, (unsigned char)*chars);
+    }
+}
+
+/** \brief Replaces a character set with its complement, so that it holds exactly the characters it did not.
+ *
+ * \param set string_charset_t* A pointer to the set.
+ * \return void Nothing.
+ *
+ */
+void string_charset_invert(string_charset_t* set)
+{
+    int pos;
+
+    if (set != NULL)
+    {
+        for (pos = 0; pos < (int)sizeof(set->bits); pos++)
+            set->bits[pos] = (unsigned char)~set->bits[pos];
+    }
+}
+
+/** \brief Builds a character set from a spec such as "a-zA-Z0-9_".
+ *
+ * \param set string_charset_t* A pointer to the set to build; its previous contents are discarded.
+ * \param spec const char* The characters of the set. "x-y" stands for the range from x to y, and a leading '^'
+ * makes the set hold every character the rest of the spec does not. A '-' at the start or the end of the spec
+ * stands for itself, and a backslash makes the character after it stand for itself.
+ * \return int A Boolean value indicating whether or not spec was valid. An invalid spec--one with a range running
+ * backwards or ending in a lone backslash--leaves the set empty.
+ *
+ */
+int string_charset_from_spec(string_charset_t* set, const char* spec)
+{
+    const unsigned char* pos    =   (const unsigned char*)spec;
+    int bool_valid              =   1;
+    int bool_inverted           =   0;
+    unsigned char first, last;
+
+    if (set == NULL || spec == NULL)
+        return 0;
+
+    string_charset_clear(set);
+
+    if (*pos == '^')
+    {
+        bool_inverted = 1;
+        pos++;
+    }
+
+    while (bool_valid && *pos != '\0')
+    {
+        if (*pos == '\\')
+            pos++;
+
+        bool_valid  =   *pos != '\0';
+        first       =   *pos;
+        last        =   first;
+
+        if (bool_valid && pos[1] == '-' && pos[2] != '\0')
+        {
+            pos += 2;
+
+            if (*pos == '\\')
+                pos++;
+
+            bool_valid  =   *pos != '\0' && *pos >= first;
+            last        =   *pos;
+        }
+
+        if (bool_valid)
+        {
+            string_charset_add_range(set, first, last);
+            pos++;
+        }
+    }
+
+    if (!bool_valid)
+        string_charset_clear(set);
+    else if (bool_inverted)
+        string_charset_invert(set);
+
+    return bool_valid;
+}
+
+/** \brief Tests whether a character is in a character set.
+ *
+ * \param set const string_charset_t* A pointer to the set.
+ * \param character unsigned char The character to look for.
+ * \return int A Boolean value, 0 for False and 1 for True.
+ *
+ */
+int string_charset_contains(const string_charset_t* set, unsigned char character)
+{
+    return (set->bits[(character & 0x80 ? 16 : 0) + (character & 0x0f)] >> ((character >> 4) & 7)) & 1;
+}
+
+/** \brief Returns one of the predefined character classes.
+ *
+ * \param char_class int One of the STRING_CLASS_* values.
+ * \return const string_charset_t* A pointer to the class's set, or NULL if char_class is not a class.
+ *
+ * The classes are those of the C locale and hold ASCII characters only. Copy one to build a set upon it.
+ */
+const string_charset_t* string_charset_class(int char_class)
+{
+    return char_class >= 0 && char_class < STRING_CLASS_COUNT ? &charset_classes[char_class] : NULL;
+}
+
+/** \brief Tests whether every character of a view is in a character set.
+ *
+ * \param view string_view_t The view to test.
+ * \param set const string_charset_t* A pointer to the set.
+ * \param first_offender int* Where to store the index of the first character not in the set, or the length of
+ * the view if there is none. May be NULL.
+ * \return int A Boolean value, 0 for False and 1 for True. NULL and 0-length views are all in any set.
+ *
+ * The view is checked many characters at a time--see string_charset_scan()--and only read up to the first
+ * offender.
+ */
+int string_view_all_in(string_view_t view, const string_charset_t* set, int* first_offender)
+{
+    int pos = 0;
+
+    if (set == NULL)
+    {
+        if (first_offender != NULL)
+            *first_offender = 0;
+
+        return 0;
+    }
+
+    if (view.chars != NULL)
+        pos = string_charset_scan(set, view.chars, view.length, 1);
+
+    if (first_offender != NULL)
+        *first_offender = pos;
+
+    return view.chars == NULL || pos == view.length;
+}
+
+/** \brief Tests whether every character of a string object is in a character set.
+ *
+ * \param str const string_t* A pointer to the string object to test.
+ * \param set const string_charset_t* A pointer to the set.
+ * \param first_offender int* Where to store the index of the first character not in the set, or the length of
+ * the string if there is none. May be NULL.
+ * \return int A Boolean value, 0 for False and 1 for True.
+ *
+ * See string_view_all_in().
+ */
+int string_all_in(const string_t* str, const string_charset_t* set, int* first_offender)
+{
+    return string_view_all_in(string_view_from_string(str), set, first_offender);
+}
+
+/** \brief Counts the characters of a string object from a position onwards that are in a character set.
+ *
+ * \param str const string_t* A pointer to the string object.
+ * \param set const string_charset_t* A pointer to the set.
+ * \param start_pos int The index to start counting at.
+ * \return int The length of the run of members starting at start_pos, or 0 if any argument is invalid.
+ *
+ * Like strspn(), but on the string object's length rather than up to a null character.
+ */
+int string_span(const string_t* str, const string_charset_t* set, int start_pos)
+{
+    int span_length = 0;
+
+    if (str != NULL && set != NULL && start_pos >= 0 && start_pos < str->length)
+        span_length = string_charset_scan(set, str->char_array + start_pos, str->length - start_pos, 1);
+
+    return span_length;
+}
+
+/** \brief Counts the characters of a string object from a position onwards that are not in a character set.
+ *
+ * \param str const string_t* A pointer to the string object.
+ * \param set const string_charset_t* A pointer to the set.
+ * \param start_pos int The index to start counting at.
+ * \return int The length of the run of non-members starting at start_pos, or 0 if any argument is invalid.
+ *
+ * Like strcspn(), but on the string object's length rather than up to a null character.
+ */
+int string_cspan(const string_t* str, const string_charset_t* set, int start_pos)
+{
+    int span_length = 0;
+
+    if (str != NULL && set != NULL && start_pos >= 0 && start_pos < str->length)
+        span_length = string_charset_scan(set, str->char_array + start_pos, str->length - start_pos, 0);
+
+    return span_length;
+}
+
+/** \brief Finds the first character of a string object, from a position onwards, that is in a character set.
+ *
+ * \param str const string_t* A pointer to the string object to search.
+ * \param set const string_charset_t* A pointer to the set.
+ * \param search_strt_pos int The index to start searching at.
+ * \return int The index of the first member found, or -1 if there is none.
+ *
+ */
+int string_find_first_of(const string_t* str, const string_charset_t* set, int search_strt_pos)
+{
+    int found_at_pos = -1;
+
+    if (str != NULL && set != NULL && search_strt_pos >= 0 && search_strt_pos < str->length)
+    {
+        found_at_pos = search_strt_pos + string_charset_scan(set, str->char_array + search_strt_pos,
+                                                             str->length - search_strt_pos, 0);
+
+        if (found_at_pos == str->length)
+            found_at_pos = -1;
+    }
+
+    return found_at_pos;
+}
+
+/** \brief Finds the last character of a string object, before a position, that is in a character set.
+ *
+ * \param str const string_t* A pointer to the string object to search.
+ * \param set const string_charset_t* A pointer to the set.
+ * \param search_end_pos int The index to stop searching before--values beyond the end search the whole string,
+ * and passing the index last found finds the member before it.
+ * \return int The index of the last member found, or -1 if there is none.
+ *
+ */
+int string_find_last_of(const string_t* str, const string_charset_t* set, int search_end_pos)
+{
+    int found_at_pos = -1;
+
+    if (str != NULL && set != NULL && search_end_pos > 0)
+    {
+        if (search_end_pos > str->length)
+            search_end_pos = str->length;
+
+        found_at_pos = string_charset_scan_reverse(set, str->char_array, search_end_pos, 0);
+    }
+
+    return found_at_pos;
+}
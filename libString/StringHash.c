@@ -0,0 +1,235 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Fast, seeded 64-bit hashing of string data, with the hash cached in the string object.
+* Filename: StringHash.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+/* The hash follows the design of wyhash: 16 bytes at a time are folded into the state with a 64x64->128-bit
+   multiply, whose high and low halves are xored back together. These are its mixing constants. */
+#define HASH_SECRET0 0xa0761d6478bd642fULL
+#define HASH_SECRET1 0xe7037ed1a0b428dbULL
+#define HASH_SECRET2 0x8ebc6af09c88c6e3ULL
+#define HASH_SECRET3 0x589965cc75374cc3ULL
+
+static unsigned long long hash_seed = 0; /* see string_set_hash_seed() */
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string hash implementation                             *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Multiplies two 64-bit values into a 128-bit product.
+ *
+ * \param low unsigned long long* The first factor on entry, the low half of the product on return.
+ * \param high unsigned long long* The second factor on entry, the high half of the product on return.
+ * \return void Nothing.
+ *
+ */
+static void hash_multiply(unsigned long long* low, unsigned long long* high)
+{
+#if defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 product = (__extension__ (unsigned __int128)*low) * *high;
+
+    *low    =   (unsigned long long)product;
+    *high   =   (unsigned long long)(product >> 64);
+#else
+    unsigned long long a_high   =   *low >> 32;
+    unsigned long long a_low    =   *low & 0xffffffffULL;
+    unsigned long long b_high   =   *high >> 32;
+    unsigned long long b_low    =   *high & 0xffffffffULL;
+    unsigned long long high_high, high_low, low_high, low_low, middle;
+
+    high_high   =   a_high * b_high;
+    high_low    =   a_high * b_low;
+    low_high    =   a_low * b_high;
+    low_low     =   a_low * b_low;
+    middle      =   (low_low >> 32) + (high_low & 0xffffffffULL) + (low_high & 0xffffffffULL);
+
+    *low    =   (low_low & 0xffffffffULL) | (middle << 32);
+    *high   =   high_high + (high_low >> 32) + (low_high >> 32) + (middle >> 32);
+#endif
+}
+
+/** \brief Mixes two 64-bit values into one.
+ *
+ * \param a unsigned long long The first value.
+ * \param b unsigned long long The second value.
+ * \return unsigned long long The high and low halves of their 128-bit product, xored together.
+ *
+ */
+static unsigned long long hash_mix(unsigned long long a, unsigned long long b)
+{
+    hash_multiply(&a, &b);
+
+    return a ^ b;
+}
+
+/** \brief Reads eight bytes as a word in the machine's byte order.
+ *
+ * \param chars const char* The bytes.
+ * \return unsigned long long The word.
+ *
+ */
+static unsigned long long hash_read8(const char* chars)
+{
+    unsigned long long word;
+
+    memcpy(&word, chars, 8);
+
+    return word;
+}
+
+/** \brief Reads four bytes as a word in the machine's byte order.
+ *
+ * \param chars const char* The bytes.
+ * \return unsigned long long The word.
+ *
+ */
+static unsigned long long hash_read4(const char* chars)
+{
+    unsigned int word;
+
+    memcpy(&word, chars, 4);
+
+    return word;
+}
+
+/** \brief Sets the seed used by string_hash().
+ *
+ * \param seed unsigned long long The new seed. The default is 0.
+ * \return void Nothing.
+ *
+ * Hash tables exposed to untrusted keys should use a random seed, so that their keys cannot be picked to collide.
+ * Call this once at start-up, before any string is hashed or interned: hashes already cached in string objects and
+ * the intern table are not recomputed.
+ */
+void string_set_hash_seed(unsigned long long seed)
+{
+    hash_seed = seed;
+}
+
+/** \brief Hashes the characters of a view with a given seed.
+ *
+ * \param view string_view_t The view to hash.
+ * \param seed unsigned long long The seed; different seeds give unrelated hashes.
+ * \return unsigned long long The 64-bit hash.
+ *
+ * Reads 48 bytes per step in three independent lanes, so long strings hash at several bytes per cycle, and
+ * short strings take a handful of multiplies. The hash is meant for hash tables: it is well distributed but not
+ * cryptographic, and its values may differ between platforms of different byte order.
+ */
+unsigned long long string_view_hash_seeded(string_view_t view, unsigned long long seed)
+{
+    const char* chars               =   view.chars;
+    unsigned long long length       =   view.chars != NULL ? (unsigned long long)view.length : 0;
+    unsigned long long remaining    =   length;
+    unsigned long long a, b, lane1, lane2;
+
+    seed ^= hash_mix(seed ^ HASH_SECRET0, HASH_SECRET1);
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            /* two overlapping pairs of 4-byte reads cover every length from 4 to 16 */
+            a   =   (hash_read4(chars) << 32) | hash_read4(chars + ((length >> 3) << 2));
+            b   =   (hash_read4(chars + length - 4) << 32) | hash_read4(chars + length - 4 - ((length >> 3) << 2));
+        }
+        else if (length > 0)
+        {
+            a   =   ((unsigned long long)(unsigned char)chars[0] << 16)
+                    | ((unsigned long long)(unsigned char)chars[length >> 1] << 8)
+                    | (unsigned long long)(unsigned char)chars[length - 1];
+            b   =   0;
+        }
+        else
+        {
+            a   =   0;
+            b   =   0;
+        }
+    }
+    else
+    {
+        if (remaining > 48)
+        {
+            lane1   =   seed;
+            lane2   =   seed;
+
+            do
+            {
+                seed    =   hash_mix(hash_read8(chars) ^ HASH_SECRET1, hash_read8(chars + 8) ^ seed);
+                lane1   =   hash_mix(hash_read8(chars + 16) ^ HASH_SECRET2, hash_read8(chars + 24) ^ lane1);
+                lane2   =   hash_mix(hash_read8(chars + 32) ^ HASH_SECRET3, hash_read8(chars + 40) ^ lane2);
+                chars       +=  48;
+                remaining   -=  48;
+            } while (remaining > 48);
+
+            seed ^= lane1 ^ lane2;
+        }
+
+        while (remaining > 16)
+        {
+            seed        =   hash_mix(hash_read8(chars) ^ HASH_SECRET1, hash_read8(chars + 8) ^ seed);
+            chars       +=  16;
+            remaining   -=  16;
+        }
+
+        /* the last 16 bytes, which may overlap bytes already mixed in */
+        a   =   hash_read8(chars + remaining - 16);
+        b   =   hash_read8(chars + remaining - 8);
+    }
+
+    a   ^=  HASH_SECRET1;
+    b   ^=  seed;
+    hash_multiply(&a, &b);
+
+    return hash_mix(a ^ HASH_SECRET0 ^ length, b ^ HASH_SECRET1);
+}
+
+/** \brief Returns the hash of a string object, computing and caching it if needed.
+ *
+ * \param str const string_t* A pointer to the string object to hash.
+ * \return unsigned long long The 64-bit hash of its characters under the seed set by string_set_hash_seed(),
+ * or the hash of a NULL view if str is NULL.
+ *
+ * The hash is cached in the string object until one of the mutating functions changes it, so hashing the same
+ * string object again is free. Storing the cache writes to the string object, so a string object must not be
+ * hashed from several threads at once unless it has been hashed before; interned string objects always have.
+ * Code that writes to char_array directly must not rely on a hash cached before the write.
+ */
+unsigned long long string_hash(const string_t* str)
+{
+    string_t* cache;
+
+    if (str == NULL)
+        return string_view_hash_seeded(string_view_from_string(NULL), hash_seed);
+
+    if (!(str->flags & STRING_FLAG_HASHED))
+    {
+        cache           =   (string_t*)str; /* the cache is not part of the string's value */
+        cache->hash     =   string_view_hash_seeded(string_view_from_string(str), hash_seed);
+        cache->flags    |=  STRING_FLAG_HASHED;
+    }
+
+    return str->hash;
+}
+
+/** \brief Hashes a view the same way string_hash() hashes a string object with the same characters.
+ *
+ * \param view string_view_t The view to hash.
+ * \return unsigned long long The 64-bit hash under the seed set by string_set_hash_seed().
+ *
+ * Lets hash tables keyed by string objects be searched with views and C strings.
+ */
+unsigned long long string_view_hash(string_view_t view)
+{
+    return string_view_hash_seeded(view, hash_seed);
+}
@@ -0,0 +1,275 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Global intern table handing out one canonical, immutable string object per distinct string.
+* Filename: StringIntern.c */
+
+/* pthread_rwlock_t is only declared by <pthread.h> in POSIX mode, which strict -std=c99 builds leave off. */
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+static SRWLOCK table_lock = SRWLOCK_INIT;
+#define READ_LOCK() (AcquireSRWLockShared(&table_lock))
+#define READ_UNLOCK() (ReleaseSRWLockShared(&table_lock))
+#define WRITE_LOCK() (AcquireSRWLockExclusive(&table_lock))
+#define WRITE_UNLOCK() (ReleaseSRWLockExclusive(&table_lock))
+#else
+#include <pthread.h>
+static pthread_rwlock_t table_lock = PTHREAD_RWLOCK_INITIALIZER;
+#define READ_LOCK() (pthread_rwlock_rdlock(&table_lock))
+#define READ_UNLOCK() (pthread_rwlock_unlock(&table_lock))
+#define WRITE_LOCK() (pthread_rwlock_wrlock(&table_lock))
+#define WRITE_UNLOCK() (pthread_rwlock_unlock(&table_lock))
+#endif
+
+#define INTERN_MIN_SLOTS 64 /* must be a power of 2 */
+
+typedef struct intern_slot_t
+{
+    unsigned long long hash;
+    string_t* str; /* NULL for an empty slot */
+} intern_slot_t;
+
+static intern_slot_t* slots     =   NULL;
+static size_t num_slots         =   0; /* always 0 or a power of 2 */
+static size_t num_interned      =   0;
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string interning implementation                        *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Looks up a run of characters in the intern table. The caller must hold the table lock.
+ *
+ * \param chars const char* The characters to look up.
+ * \param length int The number of characters.
+ * \param hash unsigned long long The hash of the characters.
+ * \return intern_slot_t* The slot holding the characters or the empty slot where they belong.
+ *
+ */
+static intern_slot_t* intern_find_slot(const char* chars, int length, unsigned long long hash)
+{
+    size_t slot_idx = (size_t)hash & (num_slots - 1);
+
+    while (slots[slot_idx].str != NULL)
+    {
+        if (slots[slot_idx].hash == hash && slots[slot_idx].str->length == length
+            && memcmp(slots[slot_idx].str->char_array, chars, length) == 0)
+            break;
+
+        slot_idx = (slot_idx + 1) & (num_slots - 1); /* linear probing */
+    }
+
+    return &slots[slot_idx];
+}
+
+/** \brief Doubles the number of slots in the intern table. The caller must hold the table lock for writing.
+ *
+ * \param None
+ * \return int A Boolean value indicating whether or not the table could be grown.
+ *
+ */
+static int intern_grow_table(void)
+{
+    intern_slot_t* old_slots    =   slots;
+    size_t old_num_slots        =   num_slots;
+    size_t new_num_slots        =   num_slots > 0 ? num_slots * 2 : INTERN_MIN_SLOTS;
+    intern_slot_t* new_slots    =   (intern_slot_t*)string_mem_calloc(new_num_slots * sizeof(intern_slot_t));
+    size_t slot_idx;
+
+    if (new_slots == NULL)
+        return 0;
+
+    slots       =   new_slots;
+    num_slots   =   new_num_slots;
+
+    for (slot_idx = 0; slot_idx < old_num_slots; slot_idx++)
+    {
+        if (old_slots[slot_idx].str != NULL)
+            *intern_find_slot(old_slots[slot_idx].str->char_array, old_slots[slot_idx].str->length,
+                              old_slots[slot_idx].hash) = old_slots[slot_idx];
+    }
+
+    string_mem_free(old_slots, old_num_slots * sizeof(intern_slot_t));
+
+    return 1;
+}
+
+/** \brief Creates the immutable string object stored in the intern table.
+ *
+ * \param chars const char* The characters of the string.
+ * \param length int The number of characters.
+ * \param hash unsigned long long The string_hash() value of the characters.
+ * \return string_t* The new string object or NULL if it could not be allocated.
+ *
+ * The characters are kept in the object's own allocation, exactly like a string_flat_init() object, and the hash
+ * is cached in it up front, so interned string objects can be hashed from any thread.
+ */
+static string_t* intern_new_string(const char* chars, int length, unsigned long long hash)
+{
+    string_t* str               =   NULL;
+    int inline_capacity         =   length + 1 > STRING_INLINE_CAPACITY ? length + 1 : STRING_INLINE_CAPACITY;
+
+    str = (string_t*)string_mem_calloc(string_object_size(inline_capacity));
+
+    if (str != NULL)
+    {
+        memcpy(str->inline_buffer, chars, length);
+        str->inline_buffer[length]  =   '\0';
+        str->char_array             =   str->inline_buffer;
+        str->length                 =   length;
+        str->capacity               =   inline_capacity;
+        str->inline_capacity        =   inline_capacity;
+        str->hash                   =   hash;
+        str->flags                  =   STRING_FLAG_IMMUTABLE | STRING_FLAG_INTERNED | STRING_FLAG_HASHED;
+    }
+
+    return str;
+}
+
+/** \brief Returns the canonical string object for a run of characters, adding it to the intern table if needed.
+ *
+ * \param chars const char* The characters to intern.
+ * \param length int The number of characters.
+ * \param hash unsigned long long The string_hash() value of the characters.
+ * \return string_t* The canonical string object or NULL if it could not be allocated.
+ *
+ * Lookups of strings already in the table only take the table lock for reading.
+ */
+static string_t* intern_chars(const char* chars, int length, unsigned long long hash)
+{
+    string_t* interned          =   NULL;
+    intern_slot_t* slot;
+
+    READ_LOCK();
+    if (num_slots > 0)
+        interned = intern_find_slot(chars, length, hash)->str;
+    READ_UNLOCK();
+
+    if (interned == NULL)
+    {
+        WRITE_LOCK();
+        if ((num_interned + 1) * 4 <= num_slots * 3 || intern_grow_table()) /* keep the load factor under 3/4 */
+        {
+            slot = intern_find_slot(chars, length, hash); /* another thread may have added it meanwhile */
+
+            if (slot->str == NULL)
+            {
+                slot->str = intern_new_string(chars, length, hash);
+
+                if (slot->str != NULL)
+                {
+                    slot->hash = hash;
+                    num_interned++;
+                }
+            }
+
+            interned = slot->str;
+        }
+        WRITE_UNLOCK();
+    }
+
+    return interned;
+}
+
+/** \brief Returns the canonical, immutable string object with the same contents as a string object.
+ *
+ * \param str const string_t* A pointer to the string object to intern.
+ * \return string_t* A pointer to the canonical string object or NULL if str is NULL or memory ran out.
+ *
+ * All calls with equal contents return the same pointer, so interned strings can be compared with
+ * string_interned_equal() and share a single copy of their characters. Interned string objects must not be
+ * modified--the mutating functions leave them unchanged--and string_destroy() ignores them. They stay valid
+ * until string_intern_cleanup() is called. The intern table may be used from several threads at once.
+ */
+string_t* string_intern(const string_t* str)
+{
+    string_t* interned = NULL;
+    unsigned long long hash;
+
+    if (str != NULL)
+    {
+        if (str->flags & STRING_FLAG_INTERNED)
+        {
+            interned = (string_t*)str; /* already canonical */
+        }
+        else
+        {
+            /* a hash cached by string_hash() saves a pass over the characters */
+            hash        =   (str->flags & STRING_FLAG_HASHED) ? str->hash : string_view_hash(string_view_from_string(str));
+            interned    =   intern_chars(str->char_array, str->length, hash);
+        }
+    }
+
+    return interned;
+}
+
+/** \brief Returns the canonical, immutable string object with the same contents as a standard C string.
+ *
+ * \param cstr const char* The C string to intern.
+ * \return string_t* A pointer to the canonical string object or NULL if cstr is NULL or memory ran out.
+ *
+ * See string_intern().
+ */
+string_t* string_intern_cstr(const char* cstr)
+{
+    string_t* interned = NULL;
+
+    if (cstr != NULL)
+        interned = intern_chars(cstr, (int)strlen(cstr), string_view_hash(string_view_from_cstr(cstr)));
+
+    return interned;
+}
+
+/** \brief Compares two interned string objects for equality.
+ *
+ * \param str1 const string_t* A string object returned by string_intern() or string_intern_cstr().
+ * \param str2 const string_t* A string object returned by string_intern() or string_intern_cstr().
+ * \return int A Boolean value indicating equality or a lack of it.
+ *
+ * Interned strings with equal contents are the same object, so this is a single pointer comparison.
+ */
+int string_interned_equal(const string_t* str1, const string_t* str2)
+{
+    return str1 == str2;
+}
+
+/** \brief Frees every interned string object and the intern table itself.
+ *
+ * \param None
+ * \return void Nothing.
+ *
+ * Every pointer previously returned by string_intern() or string_intern_cstr() becomes invalid.
+ * No other thread may be using interned strings while the table is cleaned up.
+ */
+void string_intern_cleanup(void)
+{
+    size_t slot_idx;
+    string_t* str;
+
+    WRITE_LOCK();
+    for (slot_idx = 0; slot_idx < num_slots; slot_idx++)
+    {
+        str = slots[slot_idx].str;
+
+        if (str != NULL)
+            string_mem_free(str, string_object_size(str->inline_capacity));
+    }
+
+    string_mem_free(slots, num_slots * sizeof(intern_slot_t));
+    slots           =   NULL;
+    num_slots       =   0;
+    num_interned    =   0;
+    WRITE_UNLOCK();
+}
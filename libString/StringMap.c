@@ -0,0 +1,803 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Open addressing hash map from strings to fixed-size values.
+* Filename: StringMap.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* The map is a "Swiss table": every slot has a control byte that is either MAP_CTRL_EMPTY, MAP_CTRL_DELETED or, for
+   a slot holding an entry, the low 7 bits of the entry's hash. Lookups compare a whole group of control bytes
+   against those 7 bits at once and only look at the entries whose byte matches, so a lookup rarely touches more than
+   the one entry it is after. */
+#define MAP_GROUP_SIZE 16 /* control bytes compared at once */
+#define MAP_MIN_SLOTS 16 /* must be a power of 2 of at least MAP_GROUP_SIZE */
+#define MAP_CTRL_EMPTY 0x80
+#define MAP_CTRL_DELETED 0xfe /* a tombstone left by string_map_erase()--probes continue past it */
+#define MAP_VALUE_ALIGNMENT 8 /* values are aligned to this many bytes */
+#define MAP_INLINE_KEY_SIZE 16 /* keys shorter than this are stored in the entry itself */
+
+/* The header of every entry; the value follows at MAP_VALUE_OFFSET. */
+typedef struct map_entry_t
+{
+    unsigned long long hash; /* string_hash() of the key */
+    int key_length;
+    union
+    {
+        char* heap_chars; /* null-terminated copy of a long key owned by the map */
+        char inline_chars[MAP_INLINE_KEY_SIZE]; /* null-terminated short key */
+    } key;
+} map_entry_t;
+
+#define MAP_VALUE_OFFSET ((sizeof(map_entry_t) + MAP_VALUE_ALIGNMENT - 1) / MAP_VALUE_ALIGNMENT * MAP_VALUE_ALIGNMENT)
+#define MAP_ENTRY(map, slot_idx) ((map_entry_t*)((map)->entries + (slot_idx) * (map)->entry_size))
+#define MAP_VALUE(entry) ((void*)((char*)(entry) + MAP_VALUE_OFFSET))
+#define MAP_KEY_CHARS(entry) \
+    ((entry)->key_length < MAP_INLINE_KEY_SIZE ? (entry)->key.inline_chars : (entry)->key.heap_chars)
+
+struct string_map_t
+{
+    char* entries; /* num_slots entries of entry_size bytes each, followed by the control bytes */
+    unsigned char* ctrl; /* a control byte per slot, then copies of the first MAP_GROUP_SIZE for probes that wrap */
+    size_t num_slots; /* 0 or a power of 2 of at least MAP_MIN_SLOTS */
+    size_t num_entries;
+    size_t num_deleted; /* number of MAP_CTRL_DELETED slots */
+    size_t growth_left; /* entries that can still be added before the table has to be rebuilt */
+    size_t entry_size;
+    int value_size;
+};
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string map implementation                              *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Returns the index of the lowest set bit in a non-zero mask.
+ *
+ * \param mask unsigned int The mask.
+ * \return int The index of the lowest set bit.
+ *
+ */
+static int map_lowest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+
+    while (!(mask & 1u))
+    {
+        mask >>= 1;
+        bit++;
+    }
+
+    return bit;
+#endif
+}
+
+/** \brief Returns the index of the highest set bit in a non-zero 16-bit mask.
+ *
+ * \param mask unsigned int The mask.
+ * \return int The index of the highest set bit.
+ *
+ */
+static int map_highest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(mask);
+#else
+    int bit = 15;
+
+    while (!(mask & (1u << bit)))
+        bit--;
+
+    return bit;
+#endif
+}
+
+/** \brief Finds the control bytes of a group that equal a given value.
+ *
+ * \param ctrl const unsigned char* The first of MAP_GROUP_SIZE control bytes.
+ * \param value unsigned char The value to look for.
+ * \return unsigned int A mask with bit i set if ctrl[i] equals value.
+ *
+ */
+static unsigned int map_group_match(const unsigned char* ctrl, unsigned char value)
+{
+#if defined(MAP_SSE2)
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ctrl),
+                                                          _mm_set1_epi8((char)value)));
+#else
+    unsigned int mask = 0;
+    int i;
+
+    for (i = 0; i < MAP_GROUP_SIZE; i++)
+        mask |= (unsigned int)(ctrl[i] == value) << i;
+
+    return mask;
+#endif
+}
+
+/** \brief Finds the control bytes of a group that do not hold an entry.
+ *
+ * \param ctrl const unsigned char* The first of MAP_GROUP_SIZE control bytes.
+ * \return unsigned int A mask with bit i set if ctrl[i] is MAP_CTRL_EMPTY or MAP_CTRL_DELETED.
+ *
+ */
+static unsigned int map_group_match_free(const unsigned char* ctrl)
+{
+#if defined(MAP_SSE2)
+    /* the two special values are the only ones with the high bit set */
+    return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)ctrl));
+#else
+    unsigned int mask = 0;
+    int i;
+
+    for (i = 0; i < MAP_GROUP_SIZE; i++)
+        mask |= (unsigned int)(ctrl[i] >> 7) << i;
+
+    return mask;
+#endif
+}
+
+/** \brief Sets the control byte of a slot, keeping the copies at the end of the control bytes up to date.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param slot_idx size_t The slot.
+ * \param value unsigned char The new control byte.
+ * \return void Nothing.
+ *
+ */
+static void map_set_ctrl(string_map_t* map, size_t slot_idx, unsigned char value)
+{
+    map->ctrl[slot_idx] = value;
+
+    if (slot_idx < MAP_GROUP_SIZE)
+        map->ctrl[map->num_slots + slot_idx] = value;
+}
+
+/** \brief Returns the number of slots a map needs to hold a number of entries.
+ *
+ * \param num_entries size_t The number of entries.
+ * \return size_t The smallest power of 2 of at least MAP_MIN_SLOTS that keeps the load factor at or below 7/8.
+ *
+ */
+static size_t map_slots_for(size_t num_entries)
+{
+    size_t num_slots = MAP_MIN_SLOTS;
+
+    while (num_slots - num_slots / 8 < num_entries)
+        num_slots *= 2;
+
+    return num_slots;
+}
+
+/** \brief Returns the number of bytes of the single allocation holding a table's entries and control bytes.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param num_slots size_t The number of slots of the table.
+ * \return size_t The size of the allocation.
+ *
+ */
+static size_t map_table_size(const string_map_t* map, size_t num_slots)
+{
+    return num_slots * map->entry_size + num_slots + MAP_GROUP_SIZE;
+}
+
+/** \brief Looks up the entry for a key.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param chars const char* The characters of the key.
+ * \param length int The number of characters.
+ * \param hash unsigned long long The string_hash() value of the key.
+ * \return map_entry_t* The entry or NULL if the key is not in the map.
+ *
+ * Probes the groups of slots starting at the slot picked by the hash, triangularly, until it meets a group with an
+ * empty slot. The full hash is stored with each entry and short keys are stored in it, so a lookup usually touches
+ * one cache line of control bytes and the one entry it is after.
+ */
+static map_entry_t* map_find_entry(const string_map_t* map, const char* chars, int length, unsigned long long hash)
+{
+    unsigned char tag           =   (unsigned char)(hash & 0x7f);
+    size_t slot_mask            =   map->num_slots - 1;
+    size_t pos                  =   (size_t)(hash >> 7) & slot_mask;
+    size_t step                 =   0;
+    map_entry_t* entry;
+    unsigned int matches;
+
+    if (map->num_slots == 0)
+        return NULL;
+
+    for (;;)
+    {
+        for (matches = map_group_match(map->ctrl + pos, tag); matches != 0; matches &= matches - 1)
+        {
+            entry = MAP_ENTRY(map, (pos + map_lowest_bit(matches)) & slot_mask);
+
+            if (entry->hash == hash && entry->key_length == length && memcmp(MAP_KEY_CHARS(entry), chars, length) == 0)
+                return entry;
+        }
+
+        if (map_group_match(map->ctrl + pos, MAP_CTRL_EMPTY) != 0)
+            return NULL;
+
+        step    +=  MAP_GROUP_SIZE;
+        pos     =   (pos + step) & slot_mask;
+    }
+}
+
+/** \brief Finds the first slot without an entry on the probe sequence of a hash.
+ *
+ * \param map const string_map_t* A pointer to the map, which must have at least one empty slot.
+ * \param hash unsigned long long The hash.
+ * \return size_t The index of the slot.
+ *
+ */
+static size_t map_find_free_slot(const string_map_t* map, unsigned long long hash)
+{
+    size_t slot_mask            =   map->num_slots - 1;
+    size_t pos                  =   (size_t)(hash >> 7) & slot_mask;
+    size_t step                 =   0;
+    unsigned int free_slots;
+
+    while ((free_slots = map_group_match_free(map->ctrl + pos)) == 0)
+    {
+        step    +=  MAP_GROUP_SIZE;
+        pos     =   (pos + step) & slot_mask;
+    }
+
+    return (pos + map_lowest_bit(free_slots)) & slot_mask;
+}
+
+/** \brief Moves every entry of a map into a new table.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param new_num_slots size_t The number of slots of the new table--enough for all of the entries.
+ * \return int A Boolean value indicating whether or not the new table could be allocated.
+ *
+ * Also drops the tombstones left by erased entries. The map is left unchanged if memory runs out.
+ */
+static int map_rehash(string_map_t* map, size_t new_num_slots)
+{
+    char* old_entries           =   map->entries;
+    unsigned char* old_ctrl     =   map->ctrl;
+    size_t old_num_slots        =   map->num_slots;
+    char* new_entries           =   (char*)string_mem_alloc(map_table_size(map, new_num_slots));
+    map_entry_t* entry;
+    size_t slot_idx, new_idx;
+
+    if (new_entries == NULL)
+        return 0;
+
+    map->entries        =   new_entries;
+    map->ctrl           =   (unsigned char*)new_entries + new_num_slots * map->entry_size;
+    map->num_slots      =   new_num_slots;
+    map->num_deleted    =   0;
+    map->growth_left    =   new_num_slots - new_num_slots / 8 - map->num_entries;
+    memset(map->ctrl, MAP_CTRL_EMPTY, new_num_slots + MAP_GROUP_SIZE);
+
+    for (slot_idx = 0; slot_idx < old_num_slots; slot_idx++)
+    {
+        if (!(old_ctrl[slot_idx] & 0x80))
+        {
+            entry   =   (map_entry_t*)(old_entries + slot_idx * map->entry_size);
+            new_idx =   map_find_free_slot(map, entry->hash);
+            memcpy(MAP_ENTRY(map, new_idx), entry, map->entry_size);
+            map_set_ctrl(map, new_idx, old_ctrl[slot_idx]);
+        }
+    }
+
+    if (old_entries != NULL)
+        string_mem_free(old_entries, map_table_size(map, old_num_slots));
+
+    return 1;
+}
+
+/** \brief Returns the entry for a key, adding one if the key is not in the map yet.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param chars const char* The characters of the key.
+ * \param length int The number of characters.
+ * \param hash unsigned long long The string_hash() value of the key.
+ * \param bool_inserted int* Set to whether or not the entry was added, if not NULL.
+ * \return map_entry_t* The entry or NULL if memory ran out.
+ *
+ * New entries get a copy of the key--in the entry itself if it is short--and a value whose bytes are all 0.
+ */
+static map_entry_t* map_insert_entry(string_map_t* map, const char* chars, int length, unsigned long long hash,
+                                     int* bool_inserted)
+{
+    map_entry_t* entry          =   map_find_entry(map, chars, length, hash);
+    char* heap_chars            =   NULL;
+    size_t slot_idx;
+
+    if (bool_inserted != NULL)
+        *bool_inserted = 0;
+
+    if (entry != NULL)
+        return entry;
+
+    if (map->growth_left == 0)
+    {
+        /* rebuild at the same size if that frees a worthwhile number of tombstones, otherwise double the table */
+        if (!map_rehash(map, map->num_slots == 0 ? MAP_MIN_SLOTS
+                                                 : map->num_deleted >= map->num_slots / 16 ? map->num_slots
+                                                                                          : map->num_slots * 2))
+            return NULL;
+    }
+
+    if (length >= MAP_INLINE_KEY_SIZE)
+    {
+        heap_chars = (char*)string_mem_alloc((size_t)length + 1);
+
+        if (heap_chars == NULL)
+            return NULL;
+    }
+
+    slot_idx = map_find_free_slot(map, hash);
+
+    if (map->ctrl[slot_idx] == MAP_CTRL_DELETED)
+        map->num_deleted--;
+    else
+        map->growth_left--;
+
+    map_set_ctrl(map, slot_idx, (unsigned char)(hash & 0x7f));
+    map->num_entries++;
+
+    entry               =   MAP_ENTRY(map, slot_idx);
+    entry->hash         =   hash;
+    entry->key_length   =   length;
+
+    if (heap_chars != NULL)
+        entry->key.heap_chars = heap_chars;
+
+    memcpy(MAP_KEY_CHARS(entry), chars, length);
+    MAP_KEY_CHARS(entry)[length] = '\0';
+    memset(MAP_VALUE(entry), 0, map->value_size);
+
+    if (bool_inserted != NULL)
+        *bool_inserted = 1;
+
+    return entry;
+}
+
+/** \brief Frees the copy of an entry's key if it is not stored in the entry itself.
+ *
+ * \param entry map_entry_t* A pointer to the entry.
+ * \return void Nothing.
+ *
+ */
+static void map_free_key(map_entry_t* entry)
+{
+    if (entry->key_length >= MAP_INLINE_KEY_SIZE)
+        string_mem_free(entry->key.heap_chars, (size_t)entry->key_length + 1);
+}
+
+/** \brief Removes the entry for a key.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param chars const char* The characters of the key.
+ * \param length int The number of characters.
+ * \param hash unsigned long long The string_hash() value of the key.
+ * \return int A Boolean value indicating whether or not the key was in the map.
+ *
+ * A slot can only be marked empty again if no probe can have passed over it, that is, if it does not lie inside a
+ * run of MAP_GROUP_SIZE or more consecutive slots holding entries or tombstones; otherwise it becomes a tombstone.
+ */
+static int map_erase_entry(string_map_t* map, const char* chars, int length, unsigned long long hash)
+{
+    map_entry_t* entry          =   map_find_entry(map, chars, length, hash);
+    size_t slot_idx, slot_mask;
+    unsigned int empty_before, empty_after;
+    int run_length;
+
+    if (entry == NULL)
+        return 0;
+
+    slot_mask       =   map->num_slots - 1;
+    slot_idx        =   (size_t)((char*)entry - map->entries) / map->entry_size;
+    empty_after     =   map_group_match(map->ctrl + slot_idx, MAP_CTRL_EMPTY);
+    empty_before    =   map_group_match(map->ctrl + ((slot_idx - MAP_GROUP_SIZE) & slot_mask), MAP_CTRL_EMPTY);
+    run_length      =   (empty_before != 0 ? 15 - map_highest_bit(empty_before) : MAP_GROUP_SIZE)
+                        + (empty_after != 0 ? map_lowest_bit(empty_after) : MAP_GROUP_SIZE);
+
+    map_free_key(entry);
+    map->num_entries--;
+
+    if (run_length < MAP_GROUP_SIZE)
+    {
+        map_set_ctrl(map, slot_idx, MAP_CTRL_EMPTY);
+        map->growth_left++;
+    }
+    else
+    {
+        map_set_ctrl(map, slot_idx, MAP_CTRL_DELETED);
+        map->num_deleted++;
+    }
+
+    return 1;
+}
+
+/** \brief Creates a new, empty map whose values are pointers.
+ *
+ * \param None
+ * \return string_map_t* A pointer to the new map or NULL if memory could not be allocated.
+ *
+ * Use string_map_put() and string_map_get() to store and look up the pointers.
+ */
+string_map_t* string_map_init(void)
+{
+    return string_map_cust_init((int)sizeof(void*));
+}
+
+/** \brief Creates a new, empty map whose values are blocks of a fixed size.
+ *
+ * \param value_size int The size in bytes of every value. 0 makes the map a set of strings;
+ * negative values are treated as 0.
+ * \return string_map_t* A pointer to the new map or NULL if memory could not be allocated.
+ *
+ * The map keeps its own copy of every key and stores the values in its table, aligned to 8 bytes; nothing is
+ * allocated until the first entry is added. It hashes keys with string_hash(), so a map filled before
+ * string_set_hash_seed() is called cannot be searched after. A map must not be used by more than one thread at a
+ * time.
+ */
+string_map_t* string_map_cust_init(int value_size)
+{
+    string_map_t* map = (string_map_t*)string_mem_alloc(sizeof(string_map_t));
+
+    if (map != NULL)
+    {
+        if (value_size < 0)
+            value_size = 0;
+
+        map->entries        =   NULL;
+        map->ctrl           =   NULL;
+        map->num_slots      =   0;
+        map->num_entries    =   0;
+        map->num_deleted    =   0;
+        map->growth_left    =   0;
+        map->value_size     =   value_size;
+        map->entry_size     =   (MAP_VALUE_OFFSET + (size_t)value_size + MAP_VALUE_ALIGNMENT - 1)
+                                / MAP_VALUE_ALIGNMENT * MAP_VALUE_ALIGNMENT;
+    }
+
+    return map;
+}
+
+/** \brief Removes every entry from a map.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \return void Nothing.
+ *
+ * The map keeps its table, so it can be refilled to the same size without allocating it again.
+ */
+void string_map_clear(string_map_t* map)
+{
+    size_t slot_idx;
+
+    if (map == NULL || map->num_slots == 0)
+        return;
+
+    for (slot_idx = 0; slot_idx < map->num_slots; slot_idx++)
+    {
+        if (!(map->ctrl[slot_idx] & 0x80))
+            map_free_key(MAP_ENTRY(map, slot_idx));
+    }
+
+    memset(map->ctrl, MAP_CTRL_EMPTY, map->num_slots + MAP_GROUP_SIZE);
+    map->num_entries    =   0;
+    map->num_deleted    =   0;
+    map->growth_left    =   map->num_slots - map->num_slots / 8;
+}
+
+/** \brief Frees a map and every key it holds.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \return void Nothing.
+ *
+ * Values that point to other memory are not freed--iterate over the map with string_map_next() first to do so.
+ */
+void string_map_destroy(string_map_t* map)
+{
+    if (map != NULL)
+    {
+        string_map_clear(map);
+
+        if (map->entries != NULL)
+            string_mem_free(map->entries, map_table_size(map, map->num_slots));
+
+        string_mem_free(map, sizeof(string_map_t));
+    }
+}
+
+/** \brief Returns the number of entries in a map.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \return int The number of entries. 0 if map is NULL.
+ *
+ */
+int string_map_size(const string_map_t* map)
+{
+    return map != NULL ? (int)map->num_entries : 0;
+}
+
+/** \brief Makes room in a map for a number of entries.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param num_entries int The number of entries the map should be able to hold without rebuilding its table.
+ * \return int A Boolean value indicating whether or not the room could be made.
+ *
+ * Filling a map whose final size is known after reserving room for it saves rebuilding the table as it grows.
+ */
+int string_map_reserve(string_map_t* map, int num_entries)
+{
+    size_t num_slots;
+
+    if (map == NULL || num_entries < 0)
+        return 0;
+
+    if ((size_t)num_entries <= map->num_entries + map->growth_left)
+        return 1;
+
+    num_slots = map_slots_for((size_t)num_entries);
+
+    return map_rehash(map, num_slots > map->num_slots ? num_slots : map->num_slots);
+}
+
+/** \brief Looks up the value of a key given as a view.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param key string_view_t The key.
+ * \return void* A pointer to the key's value or NULL if the key is not in the map.
+ *
+ * The pointer stays valid until the key is erased or an entry is added to the map, whichever comes first.
+ */
+void* string_map_find_view(const string_map_t* map, string_view_t key)
+{
+    map_entry_t* entry;
+
+    if (map == NULL || key.chars == NULL)
+        return NULL;
+
+    entry = map_find_entry(map, key.chars, key.length, string_view_hash(key));
+
+    return entry != NULL ? MAP_VALUE(entry) : NULL;
+}
+
+/** \brief Looks up the value of a key given as a standard C string.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param key const char* The key.
+ * \return void* A pointer to the key's value or NULL if the key is not in the map. See string_map_find_view().
+ *
+ */
+void* string_map_find_cstr(const string_map_t* map, const char* key)
+{
+    return string_map_find_view(map, string_view_from_cstr(key));
+}
+
+/** \brief Looks up the value of a key given as a string object.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param key const string_t* A pointer to the key.
+ * \return void* A pointer to the key's value or NULL if the key is not in the map. See string_map_find_view().
+ *
+ * Uses the hash cached in the string object, so looking up the same string object again does not rehash it.
+ */
+void* string_map_find(const string_map_t* map, const string_t* key)
+{
+    map_entry_t* entry;
+
+    if (map == NULL || key == NULL)
+        return NULL;
+
+    entry = map_find_entry(map, key->char_array, key->length, string_hash(key));
+
+    return entry != NULL ? MAP_VALUE(entry) : NULL;
+}
+
+/** \brief Adds a key given as a view to a map unless it is already there.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key string_view_t The key.
+ * \param bool_inserted int* Set to whether or not the key was added, if not NULL.
+ * \return void* A pointer to the key's value--all bytes 0 for a new key--or NULL if key is NULL or memory ran out.
+ *
+ * Store the value through the returned pointer. It stays valid until the key is erased or another entry is added.
+ */
+void* string_map_insert_view(string_map_t* map, string_view_t key, int* bool_inserted)
+{
+    map_entry_t* entry;
+
+    if (bool_inserted != NULL)
+        *bool_inserted = 0;
+
+    if (map == NULL || key.chars == NULL)
+        return NULL;
+
+    entry = map_insert_entry(map, key.chars, key.length, string_view_hash(key), bool_inserted);
+
+    return entry != NULL ? MAP_VALUE(entry) : NULL;
+}
+
+/** \brief Adds a key given as a standard C string to a map unless it is already there.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key const char* The key.
+ * \param bool_inserted int* Set to whether or not the key was added, if not NULL.
+ * \return void* A pointer to the key's value or NULL if key is NULL or memory ran out. See string_map_insert_view().
+ *
+ */
+void* string_map_insert_cstr(string_map_t* map, const char* key, int* bool_inserted)
+{
+    return string_map_insert_view(map, string_view_from_cstr(key), bool_inserted);
+}
+
+/** \brief Adds a key given as a string object to a map unless it is already there.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key const string_t* A pointer to the key. The map copies its characters.
+ * \param bool_inserted int* Set to whether or not the key was added, if not NULL.
+ * \return void* A pointer to the key's value or NULL if key is NULL or memory ran out. See string_map_insert_view().
+ *
+ */
+void* string_map_insert(string_map_t* map, const string_t* key, int* bool_inserted)
+{
+    map_entry_t* entry;
+
+    if (bool_inserted != NULL)
+        *bool_inserted = 0;
+
+    if (map == NULL || key == NULL)
+        return NULL;
+
+    entry = map_insert_entry(map, key->char_array, key->length, string_hash(key), bool_inserted);
+
+    return entry != NULL ? MAP_VALUE(entry) : NULL;
+}
+
+/** \brief Removes a key given as a view and its value from a map.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key string_view_t The key.
+ * \return int A Boolean value indicating whether or not the key was in the map.
+ *
+ * Erasing never moves other entries, so it is safe to erase the entry just returned by string_map_next().
+ */
+int string_map_erase_view(string_map_t* map, string_view_t key)
+{
+    if (map == NULL || key.chars == NULL)
+        return 0;
+
+    return map_erase_entry(map, key.chars, key.length, string_view_hash(key));
+}
+
+/** \brief Removes a key given as a standard C string and its value from a map.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key const char* The key.
+ * \return int A Boolean value indicating whether or not the key was in the map.
+ *
+ */
+int string_map_erase_cstr(string_map_t* map, const char* key)
+{
+    return string_map_erase_view(map, string_view_from_cstr(key));
+}
+
+/** \brief Removes a key given as a string object and its value from a map.
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key const string_t* A pointer to the key.
+ * \return int A Boolean value indicating whether or not the key was in the map.
+ *
+ */
+int string_map_erase(string_map_t* map, const string_t* key)
+{
+    if (map == NULL || key == NULL)
+        return 0;
+
+    return map_erase_entry(map, key->char_array, key->length, string_hash(key));
+}
+
+/** \brief Sets the value of a key in a map created by string_map_init().
+ *
+ * \param map string_map_t* A pointer to the map.
+ * \param key const char* The key.
+ * \param value void* The value, replacing any value the key already had.
+ * \return int A Boolean value indicating whether or not the value was stored. It is not if key is NULL, memory ran
+ * out or the map's values are not pointers.
+ *
+ */
+int string_map_put(string_map_t* map, const char* key, void* value)
+{
+    void* value_ptr;
+
+    if (map == NULL || map->value_size != (int)sizeof(void*))
+        return 0;
+
+    value_ptr = string_map_insert_cstr(map, key, NULL);
+
+    if (value_ptr != NULL)
+        memcpy(value_ptr, &value, sizeof(void*));
+
+    return value_ptr != NULL;
+}
+
+/** \brief Returns the value of a key in a map created by string_map_init().
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param key const char* The key.
+ * \return void* The key's value or NULL if the key is not in the map--use string_map_find_cstr() to tell a missing
+ * key from a NULL value.
+ *
+ */
+void* string_map_get(const string_map_t* map, const char* key)
+{
+    void* value_ptr;
+    void* value = NULL;
+
+    if (map != NULL && map->value_size == (int)sizeof(void*))
+    {
+        value_ptr = string_map_find_cstr(map, key);
+
+        if (value_ptr != NULL)
+            memcpy(&value, value_ptr, sizeof(void*));
+    }
+
+    return value;
+}
+
+/** \brief Steps through the entries of a map.
+ *
+ * \param map const string_map_t* A pointer to the map.
+ * \param iter int* The position of the iteration; set it to 0 to start from the first entry.
+ * \param key string_view_t* Set to the key of the next entry, if not NULL. Its characters are null-terminated.
+ * \param value void** Set to a pointer to the value of the next entry, if not NULL.
+ * \return int A Boolean value indicating whether or not there was another entry.
+ *
+ * Entries come in no particular order. Erasing entries during the iteration is allowed; adding entries is not.
+ */
+int string_map_next(const string_map_t* map, int* iter, string_view_t* key, void** value)
+{
+    size_t slot_idx;
+    map_entry_t* entry;
+
+    if (map == NULL || iter == NULL || *iter < 0)
+        return 0;
+
+    for (slot_idx = (size_t)*iter; slot_idx < map->num_slots; slot_idx++)
+    {
+        if (!(map->ctrl[slot_idx] & 0x80))
+        {
+            entry = MAP_ENTRY(map, slot_idx);
+
+            if (key != NULL)
+            {
+                key->chars  =   MAP_KEY_CHARS(entry);
+                key->length =   entry->key_length;
+            }
+
+            if (value != NULL)
+                *value = MAP_VALUE(entry);
+
+            *iter = (int)slot_idx + 1;
+
+            return 1;
+        }
+    }
+
+    *iter = (int)map->num_slots;
+
+    return 0;
+}
@@ -0,0 +1,459 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Aho-Corasick automaton that searches for many needles in a single pass over a haystack.
+* Filename: StringMultiMatch.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#define MULTIMATCH_DENSE_BYTES 262144 /* budget for the dense transition rows--sized to stay in the L2 cache */
+
+/* States are numbered in breadth-first order, so the shallow states a scan spends most of its time in come first.
+   States below num_dense have a full row of transitions in dense; deeper states keep only their trie edges and
+   fall back along their failure links until they reach a dense state. Every transition is stored as
+   (target state << 1) | (1 if the target state ends any needle). */
+struct string_multimatch_t
+{
+    size_t size; /* number of bytes allocated for the automaton, including this header */
+    int num_needles;
+    int num_states;
+    int num_dense; /* number of states with a dense transition row */
+    int num_classes; /* number of byte classes--class 0 holds every byte no needle contains */
+    unsigned char byte_class[256];
+    unsigned int* dense; /* num_dense rows of num_classes transitions */
+    int* edge_start; /* sparse states' trie edges are edge_class/edge_target[edge_start[s]..edge_start[s + 1]) */
+    unsigned char* edge_class; /* sorted by class within each state */
+    unsigned int* edge_target;
+    int* fail; /* longest proper suffix of each state that is also a state */
+    int* output_start; /* needles ending exactly at state s are outputs[output_start[s]..output_start[s + 1]) */
+    int* outputs;
+    int* output_link; /* nearest proper suffix state that ends a needle, or -1 */
+    int* needle_lengths;
+};
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string multimatch implementation                       *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Finds the trie child of a state during construction.
+ *
+ * \param first_child const int* First child of each state, or -1.
+ * \param next_sibling const int* Next sibling of each state, or -1.
+ * \param in_class const unsigned char* Byte class of the edge leading into each state.
+ * \param state int The parent state.
+ * \param byte_class unsigned char The byte class of the edge.
+ * \return int The child state, or -1 if there is none.
+ *
+ */
+static int multimatch_child(const int* first_child, const int* next_sibling, const unsigned char* in_class,
+                            int state, unsigned char byte_class)
+{
+    int child;
+
+    for (child = first_child[state]; child != -1 && in_class[child] != byte_class; child = next_sibling[child])
+        ;
+
+    return child;
+}
+
+/** \brief Follows one byte class from a state of a finished automaton.
+ *
+ * \param matcher const string_multimatch_t* A pointer to the automaton.
+ * \param state int The current state.
+ * \param byte_class unsigned char The byte class of the next haystack byte.
+ * \return unsigned int The encoded transition--see string_multimatch_t.
+ *
+ */
+static unsigned int multimatch_step(const string_multimatch_t* matcher, int state, unsigned char byte_class)
+{
+    int edge, last_edge;
+
+    while (state >= matcher->num_dense)
+    {
+        for (edge = matcher->edge_start[state], last_edge = matcher->edge_start[state + 1];
+             edge < last_edge && matcher->edge_class[edge] < byte_class; edge++)
+                ;
+
+        if (edge < last_edge && matcher->edge_class[edge] == byte_class)
+            return matcher->edge_target[edge];
+
+        state = matcher->fail[state];
+    }
+
+    return matcher->dense[(size_t)state * matcher->num_classes + byte_class];
+}
+
+/** \brief Builds an automaton that searches for a set of needles at once.
+ *
+ * \param needles const char** An array of C strings to search for.
+ * \param num_needles int Number of entries in needles.
+ * \return string_multimatch_t* A pointer to the new automaton, or NULL if there are no needles or memory could
+ * not be allocated.
+ *
+ * A needle's id is its index in needles. NULL and empty needles are accepted but never match. The automaton is
+ * never changed once built, so any number of threads may search with it at the same time. Free it with
+ * string_multimatch_destroy().
+ */
+string_multimatch_t* string_multimatch_init(const char** needles, int num_needles)
+{
+    string_multimatch_t* matcher    =   NULL;
+    int* scratch                    =   NULL;
+    int* first_child;
+    int* next_sibling;
+    int* first_needle;
+    int* next_needle;
+    int* bfs_order;
+    int* new_id;
+    int* old_fail;
+    unsigned char* in_class;
+    unsigned char* block;
+    size_t scratch_size, offset;
+    int total_length, max_states, num_states, state, child, needle, pos, length, head, tail;
+    int fail_state, num_edges, num_outputs, edge, sorted_edge, new_state, klass;
+    unsigned char byte_class;
+
+    if (needles == NULL || num_needles < 1)
+        return NULL;
+
+    for (needle = 0, total_length = 0; needle < num_needles; needle++)
+        total_length += needles[needle] != NULL ? (int)strlen(needles[needle]) : 0;
+
+    max_states      =   total_length + 1;
+    scratch_size    =   (size_t)max_states * (6 * sizeof(int) + 1) + (size_t)num_needles * sizeof(int);
+    scratch         =   (int*)string_mem_alloc(scratch_size);
+
+    if (scratch == NULL)
+        return NULL;
+
+    first_child     =   scratch;
+    next_sibling    =   first_child + max_states;
+    first_needle    =   next_sibling + max_states;
+    bfs_order       =   first_needle + max_states;
+    new_id          =   bfs_order + max_states;
+    old_fail        =   new_id + max_states;
+    next_needle     =   old_fail + max_states;
+    in_class        =   (unsigned char*)(next_needle + num_needles);
+
+    /* build the trie over byte classes, numbering classes in order of first appearance */
+    matcher = (string_multimatch_t*)string_mem_calloc(sizeof(string_multimatch_t));
+
+    if (matcher == NULL)
+    {
+        string_mem_free(scratch, scratch_size);
+        return NULL;
+    }
+
+    matcher->num_classes    =   1;
+    num_states              =   1;
+    first_child[0]          =   -1;
+    next_sibling[0]         =   -1;
+    first_needle[0]         =   -1;
+    in_class[0]             =   0;
+
+    for (needle = 0; needle < num_needles; needle++)
+    {
+        length = needles[needle] != NULL ? (int)strlen(needles[needle]) : 0;
+
+        for (pos = 0, state = 0; pos < length; pos++)
+        {
+            if (matcher->byte_class[(unsigned char)needles[needle][pos]] == 0)
+                matcher->byte_class[(unsigned char)needles[needle][pos]] = (unsigned char)matcher->num_classes++;
+
+            byte_class  =   matcher->byte_class[(unsigned char)needles[needle][pos]];
+            child       =   multimatch_child(first_child, next_sibling, in_class, state, byte_class);
+
+            if (child == -1)
+            {
+                child                   =   num_states++;
+                first_child[child]      =   -1;
+                first_needle[child]     =   -1;
+                in_class[child]         =   byte_class;
+                next_sibling[child]     =   first_child[state];
+                first_child[state]      =   child;
+            }
+
+            state = child;
+        }
+
+        /* empty needles would match everywhere, so they are simply never recorded */
+        if (length > 0)
+        {
+            next_needle[needle]     =   first_needle[state];
+            first_needle[state]     =   needle;
+        }
+    }
+
+    /* number the states breadth first and compute failure links on the way */
+    bfs_order[0]    =   0;
+    new_id[0]       =   0;
+    old_fail[0]     =   0;
+
+    for (head = 0, tail = 1; head < tail; head++)
+    {
+        state = bfs_order[head];
+
+        for (child = first_child[state]; child != -1; child = next_sibling[child])
+        {
+            fail_state = old_fail[state];
+
+            while (state != 0 && fail_state != 0
+                   && multimatch_child(first_child, next_sibling, in_class, fail_state, in_class[child]) == -1)
+                        fail_state = old_fail[fail_state];
+
+            if (state != 0)
+                fail_state = multimatch_child(first_child, next_sibling, in_class, fail_state, in_class[child]);
+
+            old_fail[child]         =   fail_state > 0 ? fail_state : 0;
+            new_id[child]           =   tail;
+            bfs_order[tail++]       =   child;
+        }
+    }
+
+    /* lay the automaton out in one block: the dense rows cover as many shallow states as the budget allows */
+    matcher->num_needles    =   num_needles;
+    matcher->num_states     =   num_states;
+    matcher->num_dense      =   (int)(MULTIMATCH_DENSE_BYTES / ((size_t)matcher->num_classes * sizeof(unsigned int)));
+
+    if (matcher->num_dense < 1)
+        matcher->num_dense = 1;
+
+    if (matcher->num_dense > num_states)
+        matcher->num_dense = num_states;
+
+    for (needle = 0, num_outputs = 0; needle < num_needles; needle++)
+        num_outputs += needles[needle] != NULL && needles[needle][0] != '\0';
+
+    num_edges       =   num_states - 1;
+    offset          =   sizeof(string_multimatch_t);
+    matcher->size   =   offset
+                        + (size_t)matcher->num_dense * matcher->num_classes * sizeof(unsigned int)
+                        + (size_t)num_edges * sizeof(unsigned int)
+                        + ((size_t)(num_states + 1) * 3 + num_states + num_outputs + num_needles) * sizeof(int)
+                        + (size_t)num_edges;
+    block           =   (unsigned char*)string_mem_alloc(matcher->size);
+
+    if (block == NULL)
+    {
+        string_mem_free(matcher, sizeof(string_multimatch_t));
+        string_mem_free(scratch, scratch_size);
+        return NULL;
+    }
+
+    memcpy(block, matcher, sizeof(string_multimatch_t));
+    string_mem_free(matcher, sizeof(string_multimatch_t));
+    matcher = (string_multimatch_t*)block;
+
+    matcher->dense          =   (unsigned int*)(block + offset);
+    offset                  +=  (size_t)matcher->num_dense * matcher->num_classes * sizeof(unsigned int);
+    matcher->edge_target    =   (unsigned int*)(block + offset);
+    offset                  +=  (size_t)num_edges * sizeof(unsigned int);
+    matcher->edge_start     =   (int*)(block + offset);
+    matcher->output_start   =   matcher->edge_start + num_states + 1;
+    matcher->fail           =   matcher->output_start + num_states + 1;
+    matcher->output_link    =   matcher->fail + num_states + 1;
+    matcher->outputs        =   matcher->output_link + num_states;
+    matcher->needle_lengths =   matcher->outputs + num_outputs;
+    matcher->edge_class     =   (unsigned char*)(matcher->needle_lengths + num_needles);
+
+    for (needle = 0; needle < num_needles; needle++)
+        matcher->needle_lengths[needle] = needles[needle] != NULL ? (int)strlen(needles[needle]) : 0;
+
+    /* per state, in breadth-first order: failure link, own outputs, output link and sorted trie edges */
+    for (new_state = 0, edge = 0, num_outputs = 0; new_state < num_states; new_state++)
+    {
+        state                               =   bfs_order[new_state];
+        matcher->fail[new_state]            =   new_id[old_fail[state]];
+        matcher->output_start[new_state]    =   num_outputs;
+        matcher->edge_start[new_state]      =   edge;
+
+        for (needle = first_needle[state]; needle != -1; needle = next_needle[needle])
+            matcher->outputs[num_outputs++] = needle;
+
+        fail_state = matcher->fail[new_state];
+
+        if (new_state == 0)
+            matcher->output_link[new_state] = -1;
+        else if (first_needle[bfs_order[fail_state]] != -1)
+            matcher->output_link[new_state] = fail_state;
+        else
+            matcher->output_link[new_state] = matcher->output_link[fail_state];
+
+        for (child = first_child[state]; child != -1; child = next_sibling[child])
+        {
+            /* insertion sort by class--states have few children */
+            for (sorted_edge = edge; sorted_edge > matcher->edge_start[new_state]
+                 && matcher->edge_class[sorted_edge - 1] > in_class[child]; sorted_edge--)
+            {
+                matcher->edge_class[sorted_edge]    =   matcher->edge_class[sorted_edge - 1];
+                matcher->edge_target[sorted_edge]   =   matcher->edge_target[sorted_edge - 1];
+            }
+
+            /* the has-output bit is filled in below, once every output link is known */
+            matcher->edge_class[sorted_edge]    =   in_class[child];
+            matcher->edge_target[sorted_edge]   =   (unsigned int)new_id[child];
+            edge++;
+        }
+    }
+
+    matcher->edge_start[num_states]     =   edge;
+    matcher->output_start[num_states]   =   num_outputs;
+
+    for (edge = 0; edge < num_edges; edge++)
+    {
+        new_state = (int)matcher->edge_target[edge];
+        matcher->edge_target[edge] = (unsigned int)new_state << 1
+                                     | (matcher->output_start[new_state + 1] > matcher->output_start[new_state]
+                                        || matcher->output_link[new_state] != -1);
+    }
+
+    /* dense rows: a missing edge takes the transition of the failure state, whose row is already complete */
+    for (new_state = 0; new_state < matcher->num_dense; new_state++)
+    {
+        for (klass = 0; klass < matcher->num_classes; klass++)
+        {
+            matcher->dense[(size_t)new_state * matcher->num_classes + klass] =
+                new_state == 0 ? 0 : matcher->dense[(size_t)matcher->fail[new_state] * matcher->num_classes + klass];
+        }
+
+        for (edge = matcher->edge_start[new_state]; edge < matcher->edge_start[new_state + 1]; edge++)
+            matcher->dense[(size_t)new_state * matcher->num_classes + matcher->edge_class[edge]] =
+                matcher->edge_target[edge];
+    }
+
+    string_mem_free(scratch, scratch_size);
+
+    return matcher;
+}
+
+/** \brief Frees an automaton built with string_multimatch_init().
+ *
+ * \param matcher string_multimatch_t* A pointer to the automaton.
+ * \return void Nothing.
+ *
+ */
+void string_multimatch_destroy(string_multimatch_t* matcher)
+{
+    if (matcher != NULL)
+        string_mem_free(matcher, matcher->size);
+}
+
+/** \brief Reports every needle occurrence in a string object in a single pass.
+ *
+ * \param matcher const string_multimatch_t* A pointer to the automaton.
+ * \param haystack const string_t* A pointer to the string object to search.
+ * \param callback string_multimatch_fn Called with the needle id, the index the occurrence starts at and
+ * context for each occurrence; returning non-zero stops the search. May be NULL to just count occurrences.
+ * \param context void* Passed on to callback.
+ * \return int The number of occurrences reported.
+ *
+ * Occurrences are reported in the order they end in the haystack, longest first where several end at the same
+ * character, and may overlap.
+ */
+int string_multimatch_find_all(const string_multimatch_t* matcher, const string_t* haystack,
+                               string_multimatch_fn callback, void* context)
+{
+    const unsigned char* chars;
+    unsigned int transition;
+    int state       =   0;
+    int count       =   0;
+    int bool_stop   =   0;
+    int pos, output, match_state;
+
+    if (matcher == NULL || haystack == NULL)
+        return 0;
+
+    chars = (const unsigned char*)haystack->char_array;
+
+    for (pos = 0; pos < haystack->length && !bool_stop; pos++)
+    {
+        transition  =   multimatch_step(matcher, state, matcher->byte_class[chars[pos]]);
+        state       =   (int)(transition >> 1);
+
+        if (transition & 1u)
+        {
+            for (match_state = state; match_state != -1 && !bool_stop; match_state = matcher->output_link[match_state])
+            {
+                for (output = matcher->output_start[match_state];
+                     output < matcher->output_start[match_state + 1] && !bool_stop; output++)
+                {
+                    count++;
+
+                    if (callback != NULL)
+                        bool_stop = callback(matcher->outputs[output],
+                                             pos + 1 - matcher->needle_lengths[matcher->outputs[output]], context);
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/** \brief Records the first occurrence reported by string_multimatch_find_all() and stops the search.
+ *
+ * \param needle_id int The id of the needle found.
+ * \param offset int The index the occurrence starts at.
+ * \param context void* Points to an int[2] that receives the needle id and offset.
+ * \return int Always 1, to stop the search.
+ *
+ */
+static int multimatch_record_first(int needle_id, int offset, void* context)
+{
+    ((int*)context)[0]  =   needle_id;
+    ((int*)context)[1]  =   offset;
+
+    return 1;
+}
+
+/** \brief Finds the first needle occurrence in a string object.
+ *
+ * \param matcher const string_multimatch_t* A pointer to the automaton.
+ * \param haystack const string_t* A pointer to the string object to search.
+ * \param needle_id int* Receives the id of the needle found--may be NULL.
+ * \return int The index the occurrence starts at, or -1 if no needle occurs in the haystack.
+ *
+ * The first occurrence is the one that ends first; of several ending at the same character, the longest.
+ */
+int string_multimatch_find(const string_multimatch_t* matcher, const string_t* haystack, int* needle_id)
+{
+    int first_match[2] = {-1, -1};
+
+    string_multimatch_find_all(matcher, haystack, multimatch_record_first, first_match);
+
+    if (needle_id != NULL)
+        *needle_id = first_match[0];
+
+    return first_match[1];
+}
+
+/** \brief Determines whether any needle occurs in a string object.
+ *
+ * \param matcher const string_multimatch_t* A pointer to the automaton.
+ * \param haystack const string_t* A pointer to the string object to search.
+ * \return int A Boolean value, 1 for True and 0 for False.
+ *
+ * Stops at the first character that completes an occurrence, without looking up which needle it was.
+ */
+int string_multimatch_any(const string_multimatch_t* matcher, const string_t* haystack)
+{
+    const unsigned char* chars;
+    unsigned int transition     =   0;
+    int pos;
+
+    if (matcher != NULL && haystack != NULL)
+    {
+        chars = (const unsigned char*)haystack->char_array;
+
+        for (pos = 0; pos < haystack->length && !(transition & 1u); pos++)
+            transition = multimatch_step(matcher, (int)(transition >> 1), matcher->byte_class[chars[pos]]);
+    }
+
+    return (int)(transition & 1u);
+}
@@ -0,0 +1,55 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Declarations shared between the libString translation units but not exported to users of the library.
+* Filename: StringPrivate.h */
+
+#ifndef STRINGPRIVATE_H_INCLUDED
+#define STRINGPRIVATE_H_INCLUDED
+#include <stddef.h>
+#include "String.h"
+
+/* Counters shared between threads are updated atomically where the compiler offers it. */
+#if defined(__GNUC__)
+#define STRING_ATOMIC_ADD(counter, amount) (__atomic_add_fetch(&(counter), (amount), __ATOMIC_ACQ_REL))
+#define STRING_ATOMIC_SUB(counter, amount) (__atomic_sub_fetch(&(counter), (amount), __ATOMIC_ACQ_REL))
+#define STRING_ATOMIC_LOAD(counter) (__atomic_load_n(&(counter), __ATOMIC_ACQUIRE))
+#define STRING_ATOMIC_CAS(counter, expected, desired) \
+    (__atomic_compare_exchange_n(&(counter), &(expected), (desired), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+#else
+#define STRING_ATOMIC_ADD(counter, amount) ((counter) += (amount))
+#define STRING_ATOMIC_SUB(counter, amount) ((counter) -= (amount))
+#define STRING_ATOMIC_LOAD(counter) (counter)
+#define STRING_ATOMIC_CAS(counter, expected, desired) ((counter) == (expected) ? ((counter) = (desired), 1) : 0)
+#endif
+
+#define STRING_DOUBLE_MAX_CHARS 25 /* longest output of string_format_double(): "-0.00000" and 17 digits */
+
+size_t string_object_size(int inline_capacity);
+
+void* string_mem_alloc(size_t size);
+
+void* string_mem_calloc(size_t size);
+
+void* string_mem_realloc(void* block, size_t old_size, size_t new_size);
+
+void string_mem_free(void* block, size_t size);
+
+int string_search(const char* haystack, int haystack_length, const char* needle, int needle_length);
+
+void string_case_map(char* dest, const char* source, int length, int bool_upper);
+
+int string_charset_scan(const string_charset_t* set, const char* chars, int length, int bool_members);
+
+int string_charset_scan_reverse(const string_charset_t* set, const char* chars, int length, int bool_members);
+
+int string_charset_compact(const string_charset_t* set, char* chars, int length, int bool_keep);
+
+int string_resolve_slice(int length, int beg_slice_indx, int end_slice_indx, int* slice_start, int* slice_length);
+
+void* string_arena_alloc(string_arena_t* arena, size_t size);
+
+void* string_arena_realloc(string_arena_t* arena, void* block, size_t old_size, size_t new_size);
+
+int string_format_double(char* dest, double value);
+
+#endif /* STRINGPRIVATE_H_INCLUDED */
@@ -0,0 +1,1043 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Rope representation for very large strings that are edited heavily.
+* Filename: StringRope.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#define ROPE_CHUNK_CAPACITY 4096 /* size of the chunks inserted text is stored in--larger insertions get their own */
+
+/* Chunks hold the characters and are shared, read-only, by every node that refers to a part of them. Bytes past
+   used have not been handed to any node yet, so the node ending at used may grow into them. */
+typedef struct string_rope_chunk_t
+{
+    int ref_count;
+    int capacity; /* number of bytes in chars */
+    int used; /* number of bytes of chars claimed by nodes */
+    char chars[];
+} string_rope_chunk_t;
+
+/* The rope is a treap ordered by position: every node holds one run of a chunk, its left subtree holds the text
+   before that run and its right subtree the text after it. Nodes are never changed once built--edits copy the
+   path down to the edited position and share every other subtree, so copies and slices cost O(log n). */
+typedef struct string_rope_node_t
+{
+    int ref_count;
+    unsigned int priority; /* heap order of the treap--a parent's priority is never lower than its children's */
+    int length; /* number of chars in the whole subtree */
+    struct string_rope_node_t* left;
+    struct string_rope_node_t* right;
+    string_rope_chunk_t* chunk;
+    int chunk_offset; /* index in chunk->chars of the node's first char */
+    int chunk_length; /* number of chars of the chunk the node holds */
+} string_rope_node_t;
+
+struct string_rope_t
+{
+    string_rope_node_t* root;
+    string_rope_chunk_t* append_chunk; /* chunk the rope stores inserted text in while it has room, or NULL */
+    int replace_strt_pos; /* position string_rope_replace() resumes searching at */
+    const char* old_str_to_replace; /* arguments of the last string_rope_replace() call */
+    const char* old_replacement_text;
+};
+
+static unsigned int priority_counter = 0;
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string rope implementation                             *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Returns a pseudo-random priority for a new treap node.
+ *
+ * \return unsigned int The priority.
+ *
+ * Scrambles a shared counter so that priorities are well spread without keeping any per-thread generator state.
+ */
+static unsigned int rope_next_priority(void)
+{
+    unsigned int priority = STRING_ATOMIC_ADD(priority_counter, 0x9E3779B9u);
+
+    priority    ^=  priority >> 16;
+    priority    *=  0x85EBCA6Bu;
+    priority    ^=  priority >> 13;
+    priority    *=  0xC2B2AE35u;
+    priority    ^=  priority >> 16;
+
+    return priority;
+}
+
+/** \brief Allocates a chunk and copies the given characters into it.
+ *
+ * \param chars const char* The characters to copy.
+ * \param length int Number of characters to copy.
+ * \param capacity int Number of bytes to allocate--at least length.
+ * \return string_rope_chunk_t* A pointer to the new chunk with a reference count of 0, or NULL if out of memory.
+ *
+ */
+static string_rope_chunk_t* rope_chunk_new(const char* chars, int length, int capacity)
+{
+    string_rope_chunk_t* chunk = (string_rope_chunk_t*)string_mem_alloc(offsetof(string_rope_chunk_t, chars) + capacity);
+
+    if (chunk != NULL)
+    {
+        memcpy(chunk->chars, chars, length);
+        chunk->ref_count    =   0;
+        chunk->capacity     =   capacity;
+        chunk->used         =   length;
+    }
+
+    return chunk;
+}
+
+/** \brief Drops a reference to a chunk and frees it once nothing refers to it.
+ *
+ * \param chunk string_rope_chunk_t* A pointer to the chunk.
+ * \return void Nothing.
+ *
+ */
+static void rope_chunk_release(string_rope_chunk_t* chunk)
+{
+    if (STRING_ATOMIC_SUB(chunk->ref_count, 1) == 0)
+        string_mem_free(chunk, offsetof(string_rope_chunk_t, chars) + chunk->capacity);
+}
+
+/** \brief Returns the number of characters in a subtree.
+ *
+ * \param node const string_rope_node_t* The subtree's root, or NULL for an empty subtree.
+ * \return int The number of characters.
+ *
+ */
+static int rope_node_length(const string_rope_node_t* node)
+{
+    return node != NULL ? node->length : 0;
+}
+
+/** \brief Adds a reference to a subtree.
+ *
+ * \param node string_rope_node_t* The subtree's root, or NULL.
+ * \return string_rope_node_t* node.
+ *
+ */
+static string_rope_node_t* rope_node_retain(string_rope_node_t* node)
+{
+    if (node != NULL)
+        STRING_ATOMIC_ADD(node->ref_count, 1);
+
+    return node;
+}
+
+/** \brief Drops a reference to a subtree, freeing every node and chunk nothing else refers to.
+ *
+ * \param node string_rope_node_t* The subtree's root, or NULL.
+ * \return void Nothing.
+ *
+ */
+static void rope_node_release(string_rope_node_t* node)
+{
+    string_rope_node_t* right;
+
+    /* loop down the right spine so that only the left subtrees recurse */
+    while (node != NULL && STRING_ATOMIC_SUB(node->ref_count, 1) == 0)
+    {
+        right = node->right;
+        rope_node_release(node->left);
+        rope_chunk_release(node->chunk);
+        string_mem_free(node, sizeof(string_rope_node_t));
+        node = right;
+    }
+}
+
+/** \brief Builds a node holding a run of a chunk between two subtrees.
+ *
+ * \param chunk string_rope_chunk_t* The chunk the node's characters live in.
+ * \param chunk_offset int Index of the node's first character in the chunk.
+ * \param chunk_length int Number of characters the node holds.
+ * \param priority unsigned int The node's treap priority.
+ * \param left string_rope_node_t* The subtree before the node--the new node takes over this reference.
+ * \param right string_rope_node_t* The subtree after the node--the new node takes over this reference.
+ * \return string_rope_node_t* The new node with a reference count of 1, or NULL if out of memory.
+ *
+ * left and right are released if the node cannot be allocated, so callers never need to clean them up.
+ */
+static string_rope_node_t* rope_node_new(string_rope_chunk_t* chunk, int chunk_offset, int chunk_length,
+                                         unsigned int priority, string_rope_node_t* left, string_rope_node_t* right)
+{
+    string_rope_node_t* node = (string_rope_node_t*)string_mem_alloc(sizeof(string_rope_node_t));
+
+    if (node != NULL)
+    {
+        STRING_ATOMIC_ADD(chunk->ref_count, 1);
+        node->ref_count     =   1;
+        node->priority      =   priority;
+        node->length        =   rope_node_length(left) + chunk_length + rope_node_length(right);
+        node->left          =   left;
+        node->right         =   right;
+        node->chunk         =   chunk;
+        node->chunk_offset  =   chunk_offset;
+        node->chunk_length  =   chunk_length;
+    }
+    else
+    {
+        rope_node_release(left);
+        rope_node_release(right);
+    }
+
+    return node;
+}
+
+/** \brief Builds a copy of a node with different subtrees.
+ *
+ * \param node const string_rope_node_t* The node to copy.
+ * \param left string_rope_node_t* The new left subtree--the copy takes over this reference.
+ * \param right string_rope_node_t* The new right subtree--the copy takes over this reference.
+ * \return string_rope_node_t* The copy, or NULL if out of memory.
+ *
+ */
+static string_rope_node_t* rope_node_copy(const string_rope_node_t* node, string_rope_node_t* left,
+                                          string_rope_node_t* right)
+{
+    return rope_node_new(node->chunk, node->chunk_offset, node->chunk_length, node->priority, left, right);
+}
+
+/** \brief Picks one of two subtrees at random, weighted by their lengths.
+ *
+ * \param first_length int The length of the first subtree.
+ * \param second_length int The length of the second subtree.
+ * \return int A Boolean value, true with probability first_length / (first_length + second_length).
+ *
+ */
+static int rope_pick_first(int first_length, int second_length)
+{
+    unsigned long long total = (unsigned long long)first_length + (unsigned long long)second_length;
+
+    return ((unsigned long long)rope_next_priority() * total >> 32) < (unsigned long long)first_length;
+}
+
+/** \brief Joins two subtrees so that the text of the first comes before the text of the second.
+ *
+ * \param first string_rope_node_t* The subtree holding the beginning of the text, or NULL.
+ * \param second string_rope_node_t* The subtree holding the end of the text, or NULL.
+ * \param joined string_rope_node_t** Receives a new reference to the joined subtree.
+ * \return int A Boolean value indicating whether or not the subtrees could be joined.
+ *
+ * Neither subtree is changed; the nodes along the seam are copied and everything else is shared. Ties in
+ * priority come from merging copies of the same nodes--a rope concatenated with itself--and are broken at random,
+ * as a random tree's root would be picked, so that such ropes stay balanced instead of growing into a spine.
+ */
+static int rope_merge(string_rope_node_t* first, string_rope_node_t* second, string_rope_node_t** joined)
+{
+    string_rope_node_t* sub_tree;
+    int bool_merged = 1;
+
+    if (first == NULL)
+    {
+        *joined = rope_node_retain(second);
+    }
+    else if (second == NULL)
+    {
+        *joined = rope_node_retain(first);
+    }
+    else if (first->priority > second->priority
+             || (first->priority == second->priority && rope_pick_first(first->length, second->length)))
+    {
+        bool_merged = rope_merge(first->right, second, &sub_tree)
+                      && (*joined = rope_node_copy(first, rope_node_retain(first->left), sub_tree)) != NULL;
+    }
+    else
+    {
+        bool_merged = rope_merge(first, second->left, &sub_tree)
+                      && (*joined = rope_node_copy(second, sub_tree, rope_node_retain(second->right))) != NULL;
+    }
+
+    return bool_merged;
+}
+
+/** \brief Splits a subtree into the text before a position and the text from that position on.
+ *
+ * \param node string_rope_node_t* The subtree to split, or NULL.
+ * \param pos int The split position--from 0 to the subtree's length.
+ * \param before string_rope_node_t** Receives a new reference to the text before pos.
+ * \param after string_rope_node_t** Receives a new reference to the text from pos on.
+ * \return int A Boolean value indicating whether or not the subtree could be split.
+ *
+ * The subtree is not changed. A split inside a node's run makes two nodes that share its chunk.
+ */
+static int rope_split(string_rope_node_t* node, int pos, string_rope_node_t** before, string_rope_node_t** after)
+{
+    string_rope_node_t* sub_before;
+    string_rope_node_t* sub_after;
+    int left_length     =   rope_node_length(node != NULL ? node->left : NULL);
+    int bool_split      =   1;
+
+    *before     =   NULL;
+    *after      =   NULL;
+
+    if (node == NULL || pos == 0)
+    {
+        *after = rope_node_retain(node);
+    }
+    else if (pos == node->length)
+    {
+        *before = rope_node_retain(node);
+    }
+    else if (pos == left_length)
+    {
+        *before     =   rope_node_retain(node->left);
+        *after      =   rope_node_copy(node, NULL, rope_node_retain(node->right));
+        bool_split  =   *after != NULL;
+    }
+    else if (pos < left_length)
+    {
+        if ((bool_split = rope_split(node->left, pos, &sub_before, &sub_after)))
+        {
+            *before     =   sub_before;
+            *after      =   rope_node_copy(node, sub_after, rope_node_retain(node->right));
+            bool_split  =   *after != NULL;
+        }
+    }
+    else if (pos >= left_length + node->chunk_length)
+    {
+        if ((bool_split = rope_split(node->right, pos - left_length - node->chunk_length, &sub_before, &sub_after)))
+        {
+            *before     =   rope_node_copy(node, rope_node_retain(node->left), sub_before);
+            *after      =   sub_after;
+            bool_split  =   *before != NULL;
+        }
+    }
+    else /* the split falls inside the node's own run */
+    {
+        pos         -=  left_length;
+        *before     =   rope_node_new(node->chunk, node->chunk_offset, pos, node->priority,
+                                      rope_node_retain(node->left), NULL);
+        *after      =   rope_node_new(node->chunk, node->chunk_offset + pos, node->chunk_length - pos,
+                                      node->priority, NULL, rope_node_retain(node->right));
+        bool_split  =   *before != NULL && *after != NULL;
+    }
+
+    if (!bool_split)
+    {
+        rope_node_release(*before);
+        rope_node_release(*after);
+        *before     =   NULL;
+        *after      =   NULL;
+    }
+
+    return bool_split;
+}
+
+/** \brief Appends characters to the last node of a subtree when its chunk has room right after that node's run.
+ *
+ * \param node string_rope_node_t* The subtree--must not be NULL.
+ * \param chars const char* The characters to append.
+ * \param length int Number of characters to append.
+ * \param extended string_rope_node_t** Receives a new reference to the extended subtree.
+ * \return int A Boolean value indicating whether or not the characters were appended.
+ *
+ * Lets runs of small appends and inserts share one chunk instead of allocating a chunk and a node for each.
+ */
+static int rope_extend_last(string_rope_node_t* node, const char* chars, int length, string_rope_node_t** extended)
+{
+    string_rope_node_t* sub_tree;
+    string_rope_chunk_t* chunk;
+    int run_end;
+    int bool_extended = 0;
+
+    if (node->right != NULL)
+    {
+        if (rope_extend_last(node->right, chars, length, &sub_tree))
+        {
+            *extended       =   rope_node_copy(node, rope_node_retain(node->left), sub_tree);
+            bool_extended   =   *extended != NULL;
+        }
+    }
+    else
+    {
+        chunk       =   node->chunk;
+        run_end     =   node->chunk_offset + node->chunk_length;
+
+        /* claim the bytes only if no other node has claimed them first */
+        if (chunk->capacity - run_end >= length && STRING_ATOMIC_CAS(chunk->used, run_end, run_end + length))
+        {
+            memcpy(chunk->chars + run_end, chars, length);
+            *extended       =   rope_node_new(chunk, node->chunk_offset, node->chunk_length + length, node->priority,
+                                              rope_node_retain(node->left), NULL);
+            bool_extended   =   *extended != NULL;
+        }
+    }
+
+    return bool_extended;
+}
+
+/** \brief Finds the node run containing a position.
+ *
+ * \param node const string_rope_node_t* The subtree to search.
+ * \param pos int The position--must be less than the subtree's length.
+ * \param run_start int* Receives the position of the run's first character.
+ * \return const string_rope_node_t* The node holding the character at pos.
+ *
+ */
+static const string_rope_node_t* rope_find_run(const string_rope_node_t* node, int pos, int* run_start)
+{
+    int left_length;
+
+    *run_start = 0;
+
+    for (;;)
+    {
+        left_length = rope_node_length(node->left);
+
+        if (pos < left_length)
+        {
+            node = node->left;
+        }
+        else if (pos < left_length + node->chunk_length)
+        {
+            *run_start += left_length;
+            break;
+        }
+        else
+        {
+            pos         -=  left_length + node->chunk_length;
+            *run_start  +=  left_length + node->chunk_length;
+            node        =   node->right;
+        }
+    }
+
+    return node;
+}
+
+/** \brief Copies the characters of a subtree into a buffer.
+ *
+ * \param node const string_rope_node_t* The subtree to copy.
+ * \param dest char* Where to copy the characters--must have room for the subtree's length.
+ * \return void Nothing.
+ *
+ */
+static void rope_copy_chars(const string_rope_node_t* node, char* dest)
+{
+    while (node != NULL)
+    {
+        rope_copy_chars(node->left, dest);
+        dest += rope_node_length(node->left);
+        memcpy(dest, node->chunk->chars + node->chunk_offset, node->chunk_length);
+        dest += node->chunk_length;
+        node = node->right;
+    }
+}
+
+/** \brief Replaces the rope's tree with a new one.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param root string_rope_node_t* The new tree--the rope takes over this reference.
+ * \return void Nothing.
+ *
+ */
+static void rope_set_root(string_rope_t* rope, string_rope_node_t* root)
+{
+    rope_node_release(rope->root);
+    rope->root = root;
+}
+
+/** \brief Replaces a range of the rope with the contents of another tree.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param pos int Position of the first character to replace.
+ * \param num_to_remove int Number of characters to remove at pos.
+ * \param insertion string_rope_node_t* The tree to put in their place, or NULL--it is not released.
+ * \return int A Boolean value indicating whether or not the rope was changed.
+ *
+ * The caller validates pos and num_to_remove. The rope is left as it was if memory runs out.
+ */
+static int rope_splice_tree(string_rope_t* rope, int pos, int num_to_remove, string_rope_node_t* insertion)
+{
+    string_rope_node_t* before      =   NULL;
+    string_rope_node_t* rest        =   NULL;
+    string_rope_node_t* removed     =   NULL;
+    string_rope_node_t* after       =   NULL;
+    string_rope_node_t* joined      =   NULL;
+    string_rope_node_t* result      =   NULL;
+    int bool_spliced                =   0;
+
+    if (rope_split(rope->root, pos, &before, &rest))
+    {
+        if (rope_split(rest, num_to_remove, &removed, &after))
+        {
+            if (rope_merge(before, insertion, &joined))
+            {
+                if (rope_merge(joined, after, &result))
+                {
+                    rope_set_root(rope, result);
+                    bool_spliced = 1;
+                }
+
+                rope_node_release(joined);
+            }
+
+            rope_node_release(removed);
+            rope_node_release(after);
+        }
+
+        rope_node_release(before);
+        rope_node_release(rest);
+    }
+
+    return bool_spliced;
+}
+
+/** \brief Stores characters in the rope's append chunk and builds a node holding them.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param chars const char* The characters to store.
+ * \param length int Number of characters to store--more than 0.
+ * \return string_rope_node_t* A new node with no subtrees, or NULL if out of memory.
+ *
+ * Nodes refer to their text by chunk and offset, so characters inserted anywhere in the rope are packed into one
+ * chunk after another, and a one-char edit costs a node rather than a chunk. Insertions larger than a chunk get a
+ * chunk of their own size.
+ */
+static string_rope_node_t* rope_leaf_new(string_rope_t* rope, const char* chars, int length)
+{
+    string_rope_chunk_t* chunk  =   rope->append_chunk;
+    string_rope_node_t* leaf    =   NULL;
+    int used;
+
+    /* claim the bytes past used--ropes sharing the chunk may be claiming them as well */
+    while (chunk != NULL && (used = STRING_ATOMIC_LOAD(chunk->used)) <= chunk->capacity - length)
+    {
+        if (STRING_ATOMIC_CAS(chunk->used, used, used + length))
+        {
+            memcpy(chunk->chars + used, chars, length);
+
+            return rope_node_new(chunk, used, length, rope_next_priority(), NULL, NULL);
+        }
+    }
+
+    chunk = rope_chunk_new(chars, length, length > ROPE_CHUNK_CAPACITY ? length : ROPE_CHUNK_CAPACITY);
+
+    if (chunk != NULL)
+    {
+        STRING_ATOMIC_ADD(chunk->ref_count, 1); /* held until the node is built */
+        leaf = rope_node_new(chunk, 0, length, rope_next_priority(), NULL, NULL);
+
+        if (chunk->capacity > length)
+        {
+            if (rope->append_chunk != NULL)
+                rope_chunk_release(rope->append_chunk);
+
+            STRING_ATOMIC_ADD(chunk->ref_count, 1);
+            rope->append_chunk = chunk;
+        }
+
+        rope_chunk_release(chunk);
+    }
+
+    return leaf;
+}
+
+/** \brief Inserts characters into the rope.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param pos int The position to insert at--the caller validates it.
+ * \param chars const char* The characters to insert.
+ * \param length int Number of characters to insert.
+ * \return int A Boolean value indicating whether or not the characters were inserted.
+ *
+ */
+static int rope_insert_chars(string_rope_t* rope, int pos, const char* chars, int length)
+{
+    string_rope_node_t* before      =   NULL;
+    string_rope_node_t* after       =   NULL;
+    string_rope_node_t* extended    =   NULL;
+    string_rope_node_t* insertion   =   NULL;
+    string_rope_node_t* result      =   NULL;
+    int bool_inserted               =   0;
+
+    if (length == 0)
+        return 1;
+
+    if (rope_split(rope->root, pos, &before, &after))
+    {
+        if (before != NULL && rope_extend_last(before, chars, length, &extended))
+        {
+            if (rope_merge(extended, after, &result))
+            {
+                rope_set_root(rope, result);
+                bool_inserted = 1;
+            }
+
+            rope_node_release(extended);
+        }
+        else if ((insertion = rope_leaf_new(rope, chars, length)) != NULL)
+        {
+            if (rope_merge(before, insertion, &extended))
+            {
+                if (rope_merge(extended, after, &result))
+                {
+                    rope_set_root(rope, result);
+                    bool_inserted = 1;
+                }
+
+                rope_node_release(extended);
+            }
+
+            rope_node_release(insertion);
+        }
+
+        rope_node_release(before);
+        rope_node_release(after);
+    }
+
+    return bool_inserted;
+}
+
+/** \brief Returns whether the rope holds the given characters at a position.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object.
+ * \param pos int The position to compare at--pos + length must not exceed the rope's length.
+ * \param chars const char* The characters to compare with.
+ * \param length int Number of characters to compare.
+ * \return int A Boolean value indicating whether or not the characters match.
+ *
+ */
+static int rope_matches_at(const string_rope_t* rope, int pos, const char* chars, int length)
+{
+    const string_rope_node_t* node;
+    int run_start, offset, count;
+    int bool_matches = 1;
+
+    while (bool_matches && length > 0)
+    {
+        node            =   rope_find_run(rope->root, pos, &run_start);
+        offset          =   pos - run_start;
+        count           =   node->chunk_length - offset < length ? node->chunk_length - offset : length;
+        bool_matches    =   memcmp(node->chunk->chars + node->chunk_offset + offset, chars, count) == 0;
+        pos             +=  count;
+        chars           +=  count;
+        length          -=  count;
+    }
+
+    return bool_matches;
+}
+
+/** \brief Searches the rope for a run of characters.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object.
+ * \param chars const char* The characters to find.
+ * \param length int Number of characters to find.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The position of the first occurrence at or after search_strt_pos. -1 if not found.
+ *
+ * Walks the runs in order, looking for the first character of the needle with memchr() and comparing the rest
+ * across run boundaries where needed.
+ */
+static int rope_find_chars(const string_rope_t* rope, const char* chars, int length, int search_strt_pos)
+{
+    const string_rope_node_t* node;
+    const char* run_chars;
+    const char* candidate;
+    int run_start, pos, last_pos, scan_length;
+    int ret_val = -1;
+
+    if (length > 0 && search_strt_pos >= 0 && search_strt_pos < rope_node_length(rope->root)
+        && length <= rope_node_length(rope->root))
+    {
+        pos         =   search_strt_pos;
+        last_pos    =   rope_node_length(rope->root) - length;
+
+        while (ret_val == -1 && pos <= last_pos)
+        {
+            node            =   rope_find_run(rope->root, pos, &run_start);
+            run_chars       =   node->chunk->chars + node->chunk_offset;
+            scan_length     =   run_start + node->chunk_length - pos;
+
+            if (scan_length > last_pos - pos + 1)
+                scan_length = last_pos - pos + 1;
+
+            candidate = (const char*)memchr(run_chars + (pos - run_start), chars[0], scan_length);
+
+            while (candidate != NULL)
+            {
+                pos = run_start + (int)(candidate - run_chars);
+
+                if (rope_matches_at(rope, pos + 1, chars + 1, length - 1))
+                {
+                    ret_val = pos;
+                    break;
+                }
+
+                pos++;
+                scan_length = run_start + node->chunk_length - pos;
+
+                if (scan_length > last_pos - pos + 1)
+                    scan_length = last_pos - pos + 1;
+
+                candidate = scan_length > 0 ? (const char*)memchr(run_chars + (pos - run_start), chars[0], scan_length) : NULL;
+            }
+
+            if (ret_val == -1)
+                pos = run_start + node->chunk_length;
+        }
+    }
+
+    return ret_val;
+}
+
+/** \brief Creates an empty rope.
+ *
+ * \return string_rope_t* A pointer to the new rope object, or NULL if memory could not be allocated.
+ *
+ * Destroy the rope with string_rope_destroy().
+ */
+string_rope_t* string_rope_init(void)
+{
+    return (string_rope_t*)string_mem_calloc(sizeof(string_rope_t));
+}
+
+/** \brief Creates a rope holding the contents of a C string.
+ *
+ * \param cstr const char* The C string to copy.
+ * \return string_rope_t* A pointer to the new rope object, or NULL if cstr is NULL or memory could not be allocated.
+ *
+ */
+string_rope_t* string_rope_from_cstr(const char* cstr)
+{
+    string_rope_t* rope = NULL;
+
+    if (cstr != NULL)
+    {
+        rope = string_rope_init();
+
+        if (rope != NULL && !rope_insert_chars(rope, 0, cstr, (int)strlen(cstr)))
+        {
+            string_rope_destroy(rope);
+            rope = NULL;
+        }
+    }
+
+    return rope;
+}
+
+/** \brief Creates a rope holding the contents of a string object.
+ *
+ * \param str const string_t* A pointer to the string object to copy.
+ * \return string_rope_t* A pointer to the new rope object, or NULL if str is NULL or memory could not be allocated.
+ *
+ */
+string_rope_t* string_rope_from_string(const string_t* str)
+{
+    string_rope_t* rope = NULL;
+
+    if (str != NULL)
+    {
+        rope = string_rope_init();
+
+        if (rope != NULL && !rope_insert_chars(rope, 0, str->char_array, str->length))
+        {
+            string_rope_destroy(rope);
+            rope = NULL;
+        }
+    }
+
+    return rope;
+}
+
+/** \brief Frees a rope object and whatever parts of its text no other rope shares.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \return void Nothing.
+ *
+ */
+void string_rope_destroy(string_rope_t* rope)
+{
+    if (rope != NULL)
+    {
+        rope_node_release(rope->root);
+
+        if (rope->append_chunk != NULL)
+            rope_chunk_release(rope->append_chunk);
+
+        string_mem_free(rope, sizeof(string_rope_t));
+    }
+}
+
+/** \brief Returns the number of characters in the rope.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object.
+ * \return int The rope's length, or 0 if rope is NULL.
+ *
+ */
+int string_rope_length(const string_rope_t* rope)
+{
+    return rope != NULL ? rope_node_length(rope->root) : 0;
+}
+
+/** \brief Returns the character at a position in O(log n) time.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object.
+ * \param index int The position of the character.
+ * \return int The character as an unsigned char value, or -1 if rope is NULL or index is out of range.
+ *
+ */
+int string_rope_char_at(const string_rope_t* rope, int index)
+{
+    const string_rope_node_t* node;
+    int run_start;
+    int ret_val = -1;
+
+    if (rope != NULL && index >= 0 && index < rope_node_length(rope->root))
+    {
+        node    =   rope_find_run(rope->root, index, &run_start);
+        ret_val =   (unsigned char)node->chunk->chars[node->chunk_offset + index - run_start];
+    }
+
+    return ret_val;
+}
+
+/** \brief Copies the rope's contents into a new string object.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object.
+ * \return string_t* A pointer to the new string object, or NULL if rope is NULL or memory could not be allocated.
+ *
+ */
+string_t* string_rope_to_string(const string_rope_t* rope)
+{
+    string_t* str = NULL;
+
+    if (rope != NULL)
+    {
+        str = string_cust_init(rope_node_length(rope->root) + 1);
+
+        if (str != NULL)
+        {
+            rope_copy_chars(rope->root, str->char_array);
+            str->length                     =   rope_node_length(rope->root);
+            str->char_array[str->length]    =   '\0';
+        }
+    }
+
+    return str;
+}
+
+/** \brief Returns a new rope holding a slice of another in O(log n) time.
+ *
+ * \param source const string_rope_t* A pointer to the rope object to slice.
+ * \param beg_slice_indx int Beginning slice index.
+ * \param end_slice_indx int End slice index.
+ * \return string_rope_t* A pointer to the new rope object, or NULL if the source or slice indexes are invalid
+ * or memory could not be allocated.
+ *
+ * Takes the same slice indexes as string_get_slice(). The slice shares its text with the source, so both
+ * can still be changed independently.
+ */
+string_rope_t* string_rope_get_slice(const string_rope_t* source, int beg_slice_indx, int end_slice_indx)
+{
+    string_rope_t* slice            =   NULL;
+    string_rope_node_t* before      =   NULL;
+    string_rope_node_t* rest        =   NULL;
+    string_rope_node_t* after       =   NULL;
+    int slice_start, slice_length;
+
+    if (source != NULL && string_resolve_slice(rope_node_length(source->root), beg_slice_indx, end_slice_indx,
+                                               &slice_start, &slice_length))
+    {
+        slice = string_rope_init();
+
+        if (slice != NULL && rope_split(source->root, slice_start, &before, &rest))
+        {
+            if (!rope_split(rest, slice_length, &slice->root, &after))
+            {
+                string_rope_destroy(slice);
+                slice = NULL;
+            }
+
+            rope_node_release(before);
+            rope_node_release(rest);
+            rope_node_release(after);
+        }
+        else
+        {
+            string_rope_destroy(slice);
+            slice = NULL;
+        }
+    }
+
+    return slice;
+}
+
+/** \brief Inserts a C string into the rope.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param pos int The position to insert at--from 0 to the rope's length.
+ * \param cstr const char* The C string to insert.
+ * \return int A Boolean value indicating whether or not the C string was inserted.
+ *
+ */
+int string_rope_insert_cstr(string_rope_t* rope, int pos, const char* cstr)
+{
+    int bool_inserted = 0;
+
+    if (rope != NULL && cstr != NULL && pos >= 0 && pos <= rope_node_length(rope->root))
+        bool_inserted = rope_insert_chars(rope, pos, cstr, (int)strlen(cstr));
+
+    return bool_inserted;
+}
+
+/** \brief Inserts the contents of one rope into another in O(log n) time.
+ *
+ * \param rope string_rope_t* A pointer to the rope object to insert into.
+ * \param pos int The position to insert at--from 0 to the rope's length.
+ * \param insertion const string_rope_t* A pointer to the rope object to insert--it may be rope itself.
+ * \return int A Boolean value indicating whether or not the rope was inserted.
+ *
+ * The text is shared rather than copied, and insertion is left unchanged.
+ */
+int string_rope_insert(string_rope_t* rope, int pos, const string_rope_t* insertion)
+{
+    string_rope_node_t* insertion_root;
+    int bool_inserted = 0;
+
+    if (rope != NULL && insertion != NULL && pos >= 0 && pos <= rope_node_length(rope->root))
+    {
+        insertion_root  =   rope_node_retain(insertion->root); /* keep it alive if insertion is rope */
+        bool_inserted   =   rope_splice_tree(rope, pos, 0, insertion_root);
+        rope_node_release(insertion_root);
+    }
+
+    return bool_inserted;
+}
+
+/** \brief Appends a C string to the rope.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param cstr const char* The C string to append.
+ * \return int A Boolean value indicating whether or not the C string was appended.
+ *
+ */
+int string_rope_concat_cstr(string_rope_t* rope, const char* cstr)
+{
+    return string_rope_insert_cstr(rope, string_rope_length(rope), cstr);
+}
+
+/** \brief Appends the contents of one rope to another in O(log n) time.
+ *
+ * \param rope1 string_rope_t* A pointer to the rope object to append to.
+ * \param rope2 const string_rope_t* A pointer to the rope object to append--it may be rope1 itself.
+ * \return int A Boolean value indicating whether or not the rope was appended.
+ *
+ */
+int string_rope_concat(string_rope_t* rope1, const string_rope_t* rope2)
+{
+    return string_rope_insert(rope1, string_rope_length(rope1), rope2);
+}
+
+/** \brief Removes a range of characters from the rope in O(log n) time.
+ *
+ * \param rope string_rope_t* A pointer to the rope object.
+ * \param pos int Position of the first character to remove.
+ * \param num_to_erase int Number of characters to remove.
+ * \return int A Boolean value indicating whether or not the range was removed.
+ *
+ * Nothing is removed unless the whole range lies inside the rope.
+ */
+int string_rope_erase(string_rope_t* rope, int pos, int num_to_erase)
+{
+    int bool_erased = 0;
+
+    if (rope != NULL && pos >= 0 && num_to_erase >= 0 && pos <= rope_node_length(rope->root) - num_to_erase)
+        bool_erased = num_to_erase == 0 || rope_splice_tree(rope, pos, num_to_erase, NULL);
+
+    return bool_erased;
+}
+
+/** \brief Searches for a C string within the rope and returns its index if found.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object to search.
+ * \param str_to_find const char* The C string to find.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The index of the first occurrence at or after search_strt_pos. -1 if not found.
+ *
+ * Behaves like string_find_cstr(); empty and NULL strings are never found.
+ */
+int string_rope_find_cstr(const string_rope_t* rope, const char* str_to_find, int search_strt_pos)
+{
+    int ret_val = -1;
+
+    if (rope != NULL && str_to_find != NULL)
+        ret_val = rope_find_chars(rope, str_to_find, (int)strlen(str_to_find), search_strt_pos);
+
+    return ret_val;
+}
+
+/** \brief Searches for the contents of a string object within the rope and returns its index if found.
+ *
+ * \param rope const string_rope_t* A pointer to the rope object to search.
+ * \param str_to_find const string_t* A pointer to the string object whose contents to find.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The index of the first occurrence at or after search_strt_pos. -1 if not found.
+ *
+ * Behaves like string_find(); empty and NULL strings are never found.
+ */
+int string_rope_find(const string_rope_t* rope, const string_t* str_to_find, int search_strt_pos)
+{
+    int ret_val = -1;
+
+    if (rope != NULL && str_to_find != NULL)
+        ret_val = rope_find_chars(rope, str_to_find->char_array, str_to_find->length, search_strt_pos);
+
+    return ret_val;
+}
+
+/** \brief Replaces the next occurrence of str_to_replace with replacement_text in the rope.
+ *
+ * \param rope string_rope_t* A pointer to the rope object in which to do the replacement.
+ * \param str_to_replace const char* The C string to replace.
+ * \param replacement_text const char* The C string to put in its place.
+ * \return int A Boolean value, 0 for False and 1 for True, indicating whether or not a replacement was made.
+ *
+ * Behaves like string_replace(): the first call replaces the first occurrence and subsequent, identical calls
+ * replace the next occurrence--if found. The search position is kept in the rope object rather than in
+ * static variables, so ropes can be worked on independently.
+ */
+int string_rope_replace(string_rope_t* rope, const char* str_to_replace, const char* replacement_text)
+{
+    string_rope_node_t* replacement     =   NULL;
+    int bool_replaced                   =   0;
+    int found_at_pos;
+
+    if (rope != NULL && str_to_replace != NULL && replacement_text != NULL)
+    {
+        if (rope_node_length(rope->root) > 0 && str_to_replace[0] != '\0' && replacement_text[0] != '\0')
+        {
+            if (str_to_replace != rope->old_str_to_replace || replacement_text != rope->old_replacement_text)
+            {
+                rope->replace_strt_pos          =   0;
+                rope->old_str_to_replace        =   str_to_replace;
+                rope->old_replacement_text      =   replacement_text;
+            }
+
+            found_at_pos            =   string_rope_find_cstr(rope, str_to_replace, rope->replace_strt_pos);
+            rope->replace_strt_pos  =   found_at_pos + 1;
+
+            if (found_at_pos > -1)
+            {
+                replacement = rope_leaf_new(rope, replacement_text, (int)strlen(replacement_text));
+
+                if (replacement != NULL)
+                {
+                    bool_replaced = rope_splice_tree(rope, found_at_pos, (int)strlen(str_to_replace), replacement);
+                    rope_node_release(replacement);
+                }
+            }
+        }
+    }
+
+    return bool_replaced;
+}
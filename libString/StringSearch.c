@@ -0,0 +1,617 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Vectorized substring search shared by the string find, in and replace functions, and search
+*              patterns compiled once for use on many haystacks.
+* Filename: StringSearch.c */
+
+#include <string.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SEARCH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/* The AVX2 kernel is compiled for its own target and only used when the CPU running the program supports it, so
+   the library does not have to be built for AVX2 to benefit from it. */
+#if defined(SEARCH_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__clang__) || __GNUC__ >= 5)
+#define SEARCH_AVX2 1
+#include <immintrin.h>
+#endif
+
+#define PATTERN_MEMCHR 0 /* single character needles */
+#define PATTERN_SCALAR 1 /* short needles where no vector kernel is available */
+#define PATTERN_SSE2 2
+#define PATTERN_AVX2 3
+#define PATTERN_HORSPOOL 4 /* long needles made of many different bytes--mismatches skip far ahead */
+#define PATTERN_TWO_WAY 5 /* long needles over a small alphabet--linear time however repetitive the text is */
+
+#define PATTERN_MAX_VECTOR_LENGTH 64 /* longer needles use the skip-ahead algorithms instead of the vector kernels */
+#define PATTERN_MIN_HORSPOOL_BYTES 16 /* distinct bytes a long needle needs for Boyer-Moore-Horspool to pay off */
+
+struct string_pattern_t
+{
+    char* needle;
+    int length;
+    int algorithm; /* one of the PATTERN_* values */
+    int critical_pos; /* Two-Way: last index of the needle's left half */
+    int period; /* Two-Way: how far to move after a full left-half mismatch */
+    int memory_length; /* Two-Way: length of the prefix known to match after a shift by period--0 if not periodic */
+    int shift[256]; /* Horspool: shift for each last haystack byte; Two-Way: last index + 1 of each needle byte */
+};
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string search implementation                           *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Returns the index of the lowest set bit in a non-zero mask.
+ *
+ * \param mask unsigned int The mask.
+ * \return int The index of the lowest set bit.
+ *
+ */
+static int search_lowest_bit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+
+    while (!(mask & 1u))
+    {
+        mask >>= 1;
+        bit++;
+    }
+
+    return bit;
+#endif
+}
+
+/** \brief Checks the candidate positions flagged in a match mask.
+ *
+ * \param block const char* The position of the haystack bit 0 of the mask stands for.
+ * \param mask unsigned int One bit per position whose first and last needle bytes already match.
+ * \param needle const char* The characters to find--at least 2.
+ * \param needle_length int Number of characters to find.
+ * \return int The offset from block of the first full match. -1 if none of the candidates match.
+ *
+ */
+static int search_verify_mask(const char* block, unsigned int mask, const char* needle, int needle_length)
+{
+    int bit;
+
+    while (mask != 0)
+    {
+        bit = search_lowest_bit(mask);
+
+        if (memcmp(block + bit + 1, needle + 1, needle_length - 2) == 0)
+            return bit;
+
+        mask &= mask - 1;
+    }
+
+    return -1;
+}
+
+/** \brief Searches a haystack one candidate at a time.
+ *
+ * \param haystack const char* The characters to search.
+ * \param haystack_length int Number of characters to search.
+ * \param needle const char* The characters to find.
+ * \param needle_length int Number of characters to find--at least 1 and at most haystack_length.
+ * \return int The index of the first occurrence of needle in haystack. -1 if not found.
+ *
+ * Jumps between candidates with memchr(); used on its own where no vector kernel is available and to finish
+ * the tail of the haystack the vector kernels stop short of.
+ */
+static int search_scalar(const char* haystack, int haystack_length, const char* needle, int needle_length)
+{
+    const char* candidate           =   haystack;
+    const char* last_candidate      =   haystack + haystack_length - needle_length;
+
+    while (candidate != NULL && candidate <= last_candidate)
+    {
+        candidate = (const char*)memchr(candidate, needle[0], last_candidate - candidate + 1);
+
+        if (candidate != NULL)
+        {
+            if (memcmp(candidate + 1, needle + 1, needle_length - 1) == 0)
+                return (int)(candidate - haystack);
+
+            candidate++;
+        }
+    }
+
+    return -1;
+}
+
+#if defined(SEARCH_SSE2)
+/** \brief Searches a haystack 16 candidates at a time with SSE2.
+ *
+ * \param haystack const char* The characters to search.
+ * \param haystack_length int Number of characters to search.
+ * \param needle const char* The characters to find--at least 2 and at most haystack_length.
+ * \param needle_length int Number of characters to find.
+ * \return int The index of the first occurrence of needle in haystack. -1 if not found.
+ *
+ * Compares the first and the last byte of the needle against 16 candidate positions at once, and only runs
+ * memcmp() on the positions where both match.
+ */
+static int search_sse2(const char* haystack, int haystack_length, const char* needle, int needle_length)
+{
+    const __m128i first         =   _mm_set1_epi8(needle[0]);
+    const __m128i last          =   _mm_set1_epi8(needle[needle_length - 1]);
+    __m128i block_first, block_last;
+    unsigned int mask;
+    int pos, bit, tail_pos;
+
+    for (pos = 0; pos + needle_length - 1 + 16 <= haystack_length; pos += 16)
+    {
+        block_first     =   _mm_loadu_si128((const __m128i*)(haystack + pos));
+        block_last      =   _mm_loadu_si128((const __m128i*)(haystack + pos + needle_length - 1));
+        mask            =   (unsigned int)_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, block_first),
+                                                                          _mm_cmpeq_epi8(last, block_last)));
+
+        if (mask != 0 && (bit = search_verify_mask(haystack + pos, mask, needle, needle_length)) >= 0)
+            return pos + bit;
+    }
+
+    tail_pos = search_scalar(haystack + pos, haystack_length - pos, needle, needle_length);
+
+    return tail_pos >= 0 ? pos + tail_pos : -1;
+}
+#endif
+
+#if defined(SEARCH_AVX2)
+/** \brief Searches a haystack 32 candidates at a time with AVX2.
+ *
+ * \param haystack const char* The characters to search.
+ * \param haystack_length int Number of characters to search.
+ * \param needle const char* The characters to find--at least 2 and at most haystack_length.
+ * \param needle_length int Number of characters to find.
+ * \return int The index of the first occurrence of needle in haystack. -1 if not found.
+ *
+ * Works like search_sse2() on four times as many positions per step.
+ */
+__attribute__((target("avx2")))
+static int search_avx2(const char* haystack, int haystack_length, const char* needle, int needle_length)
+{
+    const __m256i first         =   _mm256_set1_epi8(needle[0]);
+    const __m256i last          =   _mm256_set1_epi8(needle[needle_length - 1]);
+    const char* last_block      =   haystack + needle_length - 1;
+    __m256i match_low, match_high;
+    int pos, bit, tail_pos;
+
+    /* two blocks per step, so that runs without candidates cost a single test per 64 positions */
+    for (pos = 0; pos + needle_length - 1 + 64 <= haystack_length; pos += 64)
+    {
+        match_low   =   _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i*)(haystack + pos))),
+                                         _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i*)(last_block + pos))));
+        match_high  =   _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i*)(haystack + pos + 32))),
+                                         _mm256_cmpeq_epi8(last, _mm256_loadu_si256((const __m256i*)(last_block + pos + 32))));
+
+        if (_mm256_testz_si256(_mm256_or_si256(match_low, match_high), _mm256_or_si256(match_low, match_high)))
+            continue;
+
+        if ((bit = search_verify_mask(haystack + pos, (unsigned int)_mm256_movemask_epi8(match_low),
+                                      needle, needle_length)) >= 0)
+            return pos + bit;
+
+        if ((bit = search_verify_mask(haystack + pos + 32, (unsigned int)_mm256_movemask_epi8(match_high),
+                                      needle, needle_length)) >= 0)
+            return pos + 32 + bit;
+    }
+
+    tail_pos = search_sse2(haystack + pos, haystack_length - pos, needle, needle_length);
+
+    return tail_pos >= 0 ? pos + tail_pos : -1;
+}
+#endif
+
+/** \brief Returns the index of the first occurrence of needle in haystack.
+ *
+ * \param haystack const char* The characters to search.
+ * \param haystack_length int Number of characters to search.
+ * \param needle const char* The characters to find.
+ * \param needle_length int Number of characters to find.
+ * \return int The index of the first occurrence. -1 if not found or if needle is empty or longer than haystack.
+ *
+ * Single characters are found with memchr(). Longer needles use the widest vector kernel the CPU supports.
+ */
+int string_search(const char* haystack, int haystack_length, const char* needle, int needle_length)
+{
+    const char* found;
+    int ret_val = -1;
+
+    if (needle_length == 1)
+    {
+        found   =   (const char*)memchr(haystack, needle[0], haystack_length);
+        ret_val =   found != NULL ? (int)(found - haystack) : -1;
+    }
+    else if (needle_length > 1 && needle_length <= haystack_length)
+    {
+#if defined(SEARCH_AVX2)
+        if (__builtin_cpu_supports("avx2"))
+            ret_val = search_avx2(haystack, haystack_length, needle, needle_length);
+        else
+            ret_val = search_sse2(haystack, haystack_length, needle, needle_length);
+#elif defined(SEARCH_SSE2)
+        ret_val = search_sse2(haystack, haystack_length, needle, needle_length);
+#else
+        ret_val = search_scalar(haystack, haystack_length, needle, needle_length);
+#endif
+    }
+
+    return ret_val;
+}
+
+/** \brief Computes the maximal suffix of a needle for the Two-Way algorithm.
+ *
+ * \param needle const unsigned char* The needle.
+ * \param length int The needle's length.
+ * \param bool_reversed int Whether to order the bytes in reverse.
+ * \param period int* Receives the period of the maximal suffix.
+ * \return int The index just before the maximal suffix--possibly -1.
+ *
+ */
+static int pattern_maximal_suffix(const unsigned char* needle, int length, int bool_reversed, int* period)
+{
+    int suffix_pos  =   -1;
+    int candidate   =   0;
+    int offset      =   1;
+    unsigned char suffix_byte, candidate_byte;
+
+    *period = 1;
+
+    while (candidate + offset < length)
+    {
+        suffix_byte         =   needle[suffix_pos + offset];
+        candidate_byte      =   needle[candidate + offset];
+
+        if (suffix_byte == candidate_byte)
+        {
+            if (offset == *period)
+            {
+                candidate   +=  *period;
+                offset      =   1;
+            }
+            else
+            {
+                offset++;
+            }
+        }
+        else if (bool_reversed ? suffix_byte < candidate_byte : suffix_byte > candidate_byte)
+        {
+            candidate   +=  offset;
+            offset      =   1;
+            *period     =   candidate - suffix_pos;
+        }
+        else
+        {
+            suffix_pos  =   candidate++;
+            offset      =   1;
+            *period     =   1;
+        }
+    }
+
+    return suffix_pos;
+}
+
+/** \brief Prepares the critical factorization and shift table for the Two-Way algorithm.
+ *
+ * \param pattern string_pattern_t* The pattern being compiled.
+ * \return void Nothing.
+ *
+ */
+static void pattern_prepare_two_way(string_pattern_t* pattern)
+{
+    const unsigned char* needle     =   (const unsigned char*)pattern->needle;
+    int length                      =   pattern->length;
+    int pos, period, reversed_period, reversed_suffix;
+
+    for (pos = 0; pos < 256; pos++)
+        pattern->shift[pos] = 0;
+
+    for (pos = 0; pos < length; pos++)
+        pattern->shift[needle[pos]] = pos + 1;
+
+    pattern->critical_pos   =   pattern_maximal_suffix(needle, length, 0, &period);
+    reversed_suffix         =   pattern_maximal_suffix(needle, length, 1, &reversed_period);
+
+    if (reversed_suffix > pattern->critical_pos)
+    {
+        pattern->critical_pos   =   reversed_suffix;
+        period                  =   reversed_period;
+    }
+
+    if (memcmp(needle, needle + period, pattern->critical_pos + 1) == 0)
+    {
+        pattern->period         =   period;
+        pattern->memory_length  =   length - period;
+    }
+    else
+    {
+        pattern->period         =   (pattern->critical_pos > length - pattern->critical_pos - 1
+                                    ? pattern->critical_pos : length - pattern->critical_pos - 1) + 1;
+        pattern->memory_length  =   0;
+    }
+}
+
+/** \brief Searches a haystack with the Two-Way algorithm.
+ *
+ * \param pattern const string_pattern_t* The compiled pattern.
+ * \param haystack const char* The characters to search.
+ * \param haystack_length int Number of characters to search.
+ * \return int The index of the first occurrence of the pattern. -1 if not found.
+ *
+ * Runs in linear time with constant extra space, and skips ahead on the last byte of each window like
+ * Boyer-Moore-Horspool does.
+ */
+static int pattern_two_way(const string_pattern_t* pattern, const char* haystack, int haystack_length)
+{
+    const unsigned char* needle     =   (const unsigned char*)pattern->needle;
+    const unsigned char* window;
+    int length                      =   pattern->length;
+    int window_pos                  =   0;
+    int memory                      =   0;
+    int pos;
+
+    while (window_pos <= haystack_length - length)
+    {
+        window = (const unsigned char*)haystack + window_pos;
+
+        /* check the window's last byte first and shift on a mismatch */
+        pos = length - pattern->shift[window[length - 1]];
+
+        if (pos != 0)
+        {
+            window_pos  +=  pos < memory ? memory : pos;
+            memory      =   0;
+            continue;
+        }
+
+        /* compare the right half */
+        for (pos = pattern->critical_pos + 1 > memory ? pattern->critical_pos + 1 : memory;
+             pos < length && needle[pos] == window[pos]; pos++)
+                ;
+
+        if (pos < length)
+        {
+            window_pos  +=  pos - pattern->critical_pos;
+            memory      =   0;
+            continue;
+        }
+
+        /* compare the left half */
+        for (pos = pattern->critical_pos + 1; pos > memory && needle[pos - 1] == window[pos - 1]; pos--)
+            ;
+
+        if (pos <= memory)
+            return window_pos;
+
+        window_pos  +=  pattern->period;
+        memory      =   pattern->memory_length;
+    }
+
+    return -1;
+}
+
+/** \brief Searches a haystack with the Boyer-Moore-Horspool algorithm.
+ *
+ * \param pattern const string_pattern_t* The compiled pattern.
+ * \param haystack const char* The characters to search.
+ * \param haystack_length int Number of characters to search.
+ * \return int The index of the first occurrence of the pattern. -1 if not found.
+ *
+ */
+static int pattern_horspool(const string_pattern_t* pattern, const char* haystack, int haystack_length)
+{
+    const unsigned char* chars      =   (const unsigned char*)haystack;
+    int last_index                  =   pattern->length - 1;
+    unsigned char last_byte         =   (unsigned char)pattern->needle[last_index];
+    int window_pos;
+
+    for (window_pos = 0; window_pos <= haystack_length - pattern->length;
+         window_pos += pattern->shift[chars[window_pos + last_index]])
+    {
+        if (chars[window_pos + last_index] == last_byte && memcmp(haystack + window_pos, pattern->needle, last_index) == 0)
+            return window_pos;
+    }
+
+    return -1;
+}
+
+/** \brief Compiles a needle into a pattern that can be searched for in many haystacks.
+ *
+ * \param str_to_find const char* The C string to search for.
+ * \return string_pattern_t* A pointer to the new pattern, or NULL if str_to_find is NULL or empty, or memory
+ * could not be allocated.
+ *
+ * Picks the search algorithm once, from the needle's length and the number of distinct bytes in it: memchr()
+ * for single characters, the vector kernels for short needles, Boyer-Moore-Horspool for long needles over a
+ * large alphabet and Two-Way for long needles over a small one. Searching with the pattern then needs no
+ * allocation or setup. Free the pattern with string_pattern_destroy().
+ */
+string_pattern_t* string_pattern_compile(const char* str_to_find)
+{
+    string_pattern_t* pattern   =   NULL;
+    unsigned char seen[256];
+    int length, pos, distinct_bytes;
+
+    if (str_to_find != NULL && str_to_find[0] != '\0')
+    {
+        length  =   (int)strlen(str_to_find);
+        pattern =   (string_pattern_t*)string_mem_alloc(sizeof(string_pattern_t));
+
+        if (pattern != NULL)
+        {
+            pattern->needle = (char*)string_mem_alloc(length + 1);
+
+            if (pattern->needle == NULL)
+            {
+                string_mem_free(pattern, sizeof(string_pattern_t));
+                return NULL;
+            }
+
+            memcpy(pattern->needle, str_to_find, length + 1);
+            pattern->length = length;
+
+            memset(seen, 0, sizeof(seen));
+
+            for (pos = 0, distinct_bytes = 0; pos < length; pos++)
+            {
+                distinct_bytes      +=  !seen[(unsigned char)str_to_find[pos]];
+                seen[(unsigned char)str_to_find[pos]] = 1;
+            }
+
+            if (length == 1)
+            {
+                pattern->algorithm = PATTERN_MEMCHR;
+            }
+            else if (length <= PATTERN_MAX_VECTOR_LENGTH)
+            {
+#if defined(SEARCH_AVX2)
+                pattern->algorithm = __builtin_cpu_supports("avx2") ? PATTERN_AVX2 : PATTERN_SSE2;
+#elif defined(SEARCH_SSE2)
+                pattern->algorithm = PATTERN_SSE2;
+#else
+                pattern->algorithm = PATTERN_SCALAR;
+#endif
+            }
+            else if (distinct_bytes >= PATTERN_MIN_HORSPOOL_BYTES)
+            {
+                pattern->algorithm = PATTERN_HORSPOOL;
+
+                for (pos = 0; pos < 256; pos++)
+                    pattern->shift[pos] = length;
+
+                for (pos = 0; pos < length - 1; pos++)
+                    pattern->shift[(unsigned char)str_to_find[pos]] = length - 1 - pos;
+            }
+            else
+            {
+                pattern->algorithm = PATTERN_TWO_WAY;
+                pattern_prepare_two_way(pattern);
+            }
+        }
+    }
+
+    return pattern;
+}
+
+/** \brief Frees a compiled pattern.
+ *
+ * \param pattern string_pattern_t* A pointer to the pattern.
+ * \return void Nothing.
+ *
+ */
+void string_pattern_destroy(string_pattern_t* pattern)
+{
+    if (pattern != NULL)
+    {
+        string_mem_free(pattern->needle, pattern->length + 1);
+        string_mem_free(pattern, sizeof(string_pattern_t));
+    }
+}
+
+/** \brief Searches a view for a compiled pattern.
+ *
+ * \param pattern const string_pattern_t* A pointer to the pattern.
+ * \param haystack string_view_t The view to search.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The index of the first occurrence at or after search_strt_pos. -1 if not found.
+ *
+ */
+int string_pattern_find_view(const string_pattern_t* pattern, string_view_t haystack, int search_strt_pos)
+{
+    const char* chars;
+    const char* found;
+    int length;
+    int ret_val = -1;
+
+    if (pattern != NULL && haystack.chars != NULL && search_strt_pos >= 0 && search_strt_pos < haystack.length)
+    {
+        chars   =   haystack.chars + search_strt_pos;
+        length  =   haystack.length - search_strt_pos;
+
+        if (pattern->algorithm == PATTERN_MEMCHR)
+        {
+            found   =   (const char*)memchr(chars, pattern->needle[0], length);
+            ret_val =   found != NULL ? (int)(found - chars) : -1;
+        }
+        else if (pattern->length <= length)
+        {
+            switch (pattern->algorithm)
+            {
+#if defined(SEARCH_AVX2)
+                case PATTERN_AVX2:
+                    ret_val = search_avx2(chars, length, pattern->needle, pattern->length);
+                    break;
+#endif
+#if defined(SEARCH_SSE2)
+                case PATTERN_SSE2:
+                    ret_val = search_sse2(chars, length, pattern->needle, pattern->length);
+                    break;
+#endif
+                case PATTERN_HORSPOOL:
+                    ret_val = pattern_horspool(pattern, chars, length);
+                    break;
+                case PATTERN_TWO_WAY:
+                    ret_val = pattern_two_way(pattern, chars, length);
+                    break;
+                default:
+                    ret_val = search_scalar(chars, length, pattern->needle, pattern->length);
+                    break;
+            }
+        }
+
+        if (ret_val >= 0)
+            ret_val += search_strt_pos;
+    }
+
+    return ret_val;
+}
+
+/** \brief Searches a string object for a compiled pattern.
+ *
+ * \param pattern const string_pattern_t* A pointer to the pattern.
+ * \param haystack const string_t* A pointer to the string object to search.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The index of the first occurrence at or after search_strt_pos. -1 if not found.
+ *
+ * Finds the same occurrences as string_find_cstr() does with the C string the pattern was compiled from.
+ */
+int string_pattern_find(const string_pattern_t* pattern, const string_t* haystack, int search_strt_pos)
+{
+    return string_pattern_find_view(pattern, string_view_from_string(haystack), search_strt_pos);
+}
+
+/** \brief Counts the non-overlapping occurrences of a compiled pattern in a string object.
+ *
+ * \param pattern const string_pattern_t* A pointer to the pattern.
+ * \param haystack const string_t* A pointer to the string object to search.
+ * \return int The number of occurrences, counted from left to right without overlapping. 0 if either is NULL.
+ *
+ */
+int string_pattern_count(const string_pattern_t* pattern, const string_t* haystack)
+{
+    string_view_t view  =   string_view_from_string(haystack);
+    int count           =   0;
+    int found_at_pos    =   string_pattern_find_view(pattern, view, 0);
+
+    while (found_at_pos >= 0)
+    {
+        count++;
+        found_at_pos = string_pattern_find_view(pattern, view, found_at_pos + pattern->length);
+    }
+
+    return count;
+}
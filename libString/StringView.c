@@ -0,0 +1,378 @@
+/* Created By: Jason MacLafferty
+* Date of Creation: May 2013
+* Description: Non-owning views of string data and the read-only string operations implemented on them.
+* Filename: StringView.c */
+
+#include <string.h>
+#include <limits.h>
+#include "String.h"
+#include "StringPrivate.h"
+
+/**********************************************************************************
+*                                                                                 *
+*                                                                                 *
+*                          string view implementation                             *
+*                                                                                 *
+*                                                                                 *
+***********************************************************************************/
+
+
+
+/** \brief Returns a view of the whole contents of a string object.
+ *
+ * \param str const string_t* A pointer to the string object to view.
+ * \return string_view_t A view of the string object's characters, or a NULL view if str is NULL.
+ *
+ * The view stays valid until the string object is changed or destroyed.
+ */
+string_view_t string_view_from_string(const string_t* str)
+{
+    string_view_t view = {NULL, 0};
+
+    if (str != NULL)
+    {
+        view.chars      =   str->char_array;
+        view.length     =   str->length;
+    }
+
+    return view;
+}
+
+/** \brief Returns a view of a standard C string.
+ *
+ * \param cstr const char* The C string to view.
+ * \return string_view_t A view of the C string's characters, or a NULL view if cstr is NULL.
+ *
+ */
+string_view_t string_view_from_cstr(const char* cstr)
+{
+    string_view_t view = {NULL, 0};
+
+    if (cstr != NULL)
+    {
+        view.chars      =   cstr;
+        view.length     =   (int)strlen(cstr);
+    }
+
+    return view;
+}
+
+/** \brief Resolves Python style slice indexes against a string of the given length.
+ *
+ * \param length int The length of the string being sliced.
+ * \param beg_slice_indx int Beginning slice index, or -1.
+ * \param end_slice_indx int End slice index, or -1.
+ * \param slice_start int* Receives the index of the first character in the slice.
+ * \param slice_length int* Receives the number of characters in the slice.
+ * \return int A Boolean value indicating whether or not the slice indexes are valid.
+ *
+ * See string_get_slice() for the slice syntax.
+ */
+int string_resolve_slice(int length, int beg_slice_indx, int end_slice_indx, int* slice_start, int* slice_length)
+{
+    int bool_valid = 0;
+
+    if (length > 0)
+    {
+        if (beg_slice_indx >= 0 && beg_slice_indx < length)
+        {
+            if (end_slice_indx > 0 && end_slice_indx <= length && beg_slice_indx < end_slice_indx)
+            {
+                bool_valid = 1;
+            }
+            else if (end_slice_indx == -1)
+            {
+                end_slice_indx  =   length;
+                bool_valid      =   1;
+            }
+        }
+        else if (beg_slice_indx == -1 && end_slice_indx == -1) /* imitate a python [:] slice operation. */
+        {
+            beg_slice_indx      =   0;
+            end_slice_indx      =   length;
+            bool_valid          =   1;
+        }
+    }
+
+    if (bool_valid)
+    {
+        *slice_start    =   beg_slice_indx;
+        *slice_length   =   end_slice_indx - beg_slice_indx;
+    }
+
+    return bool_valid;
+}
+
+/** \brief Returns a view of a slice of a string object without allocating anything.
+ *
+ * \param source const string_t* A pointer to the string object to slice.
+ * \param beg_slice_indx int Beginning slice index.
+ * \param end_slice_indx int End slice index.
+ * \return string_view_t A view of the slice, or a NULL view if the source or the slice indexes are invalid.
+ *
+ * Takes the same slice indexes as string_get_slice(), but the result refers to the source's characters
+ * and stays valid only until the source is changed or destroyed.
+ */
+string_view_t string_slice_view(const string_t* source, int beg_slice_indx, int end_slice_indx)
+{
+    return string_view_slice(string_view_from_string(source), beg_slice_indx, end_slice_indx);
+}
+
+/** \brief Returns a view of a slice of another view.
+ *
+ * \param source string_view_t The view to slice.
+ * \param beg_slice_indx int Beginning slice index.
+ * \param end_slice_indx int End slice index.
+ * \return string_view_t A view of the slice, or a NULL view if the source or the slice indexes are invalid.
+ *
+ * Takes the same slice indexes as string_get_slice().
+ */
+string_view_t string_view_slice(string_view_t source, int beg_slice_indx, int end_slice_indx)
+{
+    string_view_t slice = {NULL, 0};
+    int slice_start, slice_length;
+
+    if (source.chars != NULL && string_resolve_slice(source.length, beg_slice_indx, end_slice_indx,
+                                                     &slice_start, &slice_length))
+    {
+        slice.chars     =   source.chars + slice_start;
+        slice.length    =   slice_length;
+    }
+
+    return slice;
+}
+
+/** \brief Copies the characters of a view into a new string object.
+ *
+ * \param view string_view_t The view to copy.
+ * \return string_t* A pointer to the new string object, or NULL for a NULL view or if memory ran out.
+ *
+ */
+string_t* string_view_to_string(string_view_t view)
+{
+    string_t* str = NULL;
+
+    if (view.chars != NULL)
+    {
+        str = string_cust_init(view.length + 1);
+
+        if (str != NULL)
+        {
+            memcpy(str->char_array, view.chars, view.length);
+            str->char_array[view.length]    =   '\0';
+            str->length                     =   view.length;
+        }
+    }
+
+    return str;
+}
+
+/** \brief Compares two views to see if they contain identical strings.
+ *
+ * \param view1 string_view_t The first view.
+ * \param view2 string_view_t The second view.
+ * \return int A Boolean value indicating equality or a lack of it.
+ *
+ * Two NULL views are equal; a NULL view is never equal to a non-NULL one.
+ */
+int string_view_equal(string_view_t view1, string_view_t view2)
+{
+    int return_val = 0;
+
+    if (view1.chars != NULL && view2.chars != NULL)
+        return_val = view1.length == view2.length && memcmp(view1.chars, view2.chars, view1.length) == 0;
+    else if (view1.chars == NULL && view2.chars == NULL)
+        return_val = 1; /* NULL = NULL */
+
+    return return_val;
+}
+
+/** \brief Compares a view and a standard C string.
+ *
+ * \param view string_view_t The view.
+ * \param cstr const char* The C string.
+ * \return int A Boolean value indicating equality or a lack of it. False if either argument is NULL.
+ *
+ */
+int string_view_equal_cstring(string_view_t view, const char* cstr)
+{
+    int return_val = 0;
+
+    if (view.chars != NULL && cstr != NULL)
+        return_val = view.length == (int)strlen(cstr) && memcmp(view.chars, cstr, view.length) == 0;
+
+    return return_val;
+}
+
+/** \brief Compares two views in lexicographical order.
+ *
+ * \param view1 string_view_t The first view.
+ * \param view2 string_view_t The second view.
+ * \return int A value less than, equal to or greater than 0 as view1 sorts before, the same as or after view2.
+ *
+ * Bytes compare as unsigned values, embedded null characters included, and a view sorts after each of its proper
+ * prefixes. A NULL view sorts before every other view. Views of the same characters compare without reading them.
+ */
+int string_view_compare(string_view_t view1, string_view_t view2)
+{
+    int result = 0;
+
+    if (view1.chars == NULL || view2.chars == NULL)
+        return (view1.chars != NULL) - (view2.chars != NULL);
+
+    if (view1.chars != view2.chars)
+        result = memcmp(view1.chars, view2.chars, view1.length < view2.length ? view1.length : view2.length);
+
+    if (result == 0)
+        result = (view1.length > view2.length) - (view1.length < view2.length);
+
+    return result;
+}
+
+/** \brief Searches for a needle in a view and returns its index if found.
+ *
+ * \param haystack string_view_t The view to search.
+ * \param needle string_view_t The view to find.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The index of the first occurrence of needle at or after search_strt_pos. -1 if not found.
+ *
+ * Empty and NULL needles are never found.
+ */
+int string_view_find(string_view_t haystack, string_view_t needle, int search_strt_pos)
+{
+    int ret_val = -1;
+
+    if (haystack.chars != NULL && needle.chars != NULL && needle.length > 0)
+    {
+        if (search_strt_pos >= 0 && search_strt_pos < haystack.length)
+        {
+            ret_val = string_search(haystack.chars + search_strt_pos, haystack.length - search_strt_pos,
+                                    needle.chars, needle.length);
+
+            if (ret_val >= 0)
+                ret_val += search_strt_pos;
+        }
+    }
+
+    return ret_val;
+}
+
+/** \brief Searches for a standard C string in a view and returns its index if found.
+ *
+ * \param haystack string_view_t The view to search.
+ * \param str_to_find const char* The C string to find.
+ * \param search_strt_pos int The character position to start searching at.
+ * \return int The index of the first occurrence of str_to_find at or after search_strt_pos. -1 if not found.
+ *
+ */
+int string_view_find_cstr(string_view_t haystack, const char* str_to_find, int search_strt_pos)
+{
+    return string_view_find(haystack, string_view_from_cstr(str_to_find), search_strt_pos);
+}
+
+/** \brief Imitates the Python "in" operator for views.
+ *
+ * \param haystack string_view_t The view to search.
+ * \param str_to_find const char* The C string to look for.
+ * \return int Boolean, 1 for True, 0 for False
+ *
+ */
+int string_view_in(string_view_t haystack, const char* str_to_find)
+{
+    return string_view_find_cstr(haystack, str_to_find, 0) >= 0;
+}
+
+/** \brief Returns a Boolean value indicating whether the view contains a valid integer.
+ *
+ * \param view string_view_t The view to check.
+ * \return int A Boolean value indicating True or False.
+ *
+ * A valid integer is a run of digits, optionally preceded by a negative sign.
+ * NULL and 0-length views are not valid integers.
+ */
+int string_view_is_int(string_view_t view)
+{
+    int sign_length;
+
+    if (view.chars == NULL || view.length == 0)
+        return 0;
+
+    sign_length = view.chars[0] == '-';
+
+    /* a lone '-' is not an integer */
+    return sign_length < view.length
+           && string_charset_scan(string_charset_class(STRING_CLASS_DIGIT), view.chars + sign_length,
+                                  view.length - sign_length, 1) == view.length - sign_length;
+}
+
+/** \brief Returns the integer corresponding to the string form of the integer in a view.
+ *
+ * \param view string_view_t The view to convert.
+ * \return int The signed integer equivalent to the view, or -1 for a NULL view, -2 for a 0-length view and
+ * -3 if the view is not a valid integer or does not fit in an int.
+ *
+ * The error codes are valid results as well--use string_view_to_int64() to tell them apart.
+ */
+int string_view_toint(string_view_t view)
+{
+    int return_val;
+    long long value;
+
+    if (view.chars == NULL)
+    {
+        return_val = -1; /* the view is NULL and cannot be converted. */
+    }
+    else if (view.length == 0)
+    {
+        return_val = -2; /* the view is of zero-length and so therefore not an integer */
+    }
+    else if (!string_view_is_int(view))
+    {
+        return_val = -3; /* the view is not a valid integer. */
+    }
+    else if (string_view_to_int64(view, &value, 10) != STRING_NUM_OK || value < INT_MIN || value > INT_MAX)
+    {
+        return_val = -3; /* the integer is out of range. */
+    }
+    else
+    {
+        return_val = (int)value;
+    }
+
+    return return_val;
+}
+
+/** \brief Tests whether a view contains strictly alphabetical characters.
+ *
+ * \param view string_view_t The view to test.
+ * \return int A Boolean value. NULL and 0-length views count as alphabetical.
+ *
+ */
+int string_view_isalpha(string_view_t view)
+{
+    return string_view_all_in(view, string_charset_class(STRING_CLASS_ALPHA), NULL);
+}
+
+/** \brief Tests whether a view contains strictly alphanumeric characters.
+ *
+ * \param view string_view_t The view to test.
+ * \return int A Boolean value. NULL and 0-length views are not alphanumeric.
+ *
+ */
+int string_view_isalphanum(string_view_t view)
+{
+    return view.chars != NULL && view.length > 0
+           && string_view_all_in(view, string_charset_class(STRING_CLASS_ALPHANUM), NULL);
+}
+
+/** \brief Tests whether a view contains strictly non-alphabetical characters.
+ *
+ * \param view string_view_t The view to test.
+ * \return int A Boolean value. NULL and 0-length views are defined to be non-alphabetical.
+ *
+ */
+int string_view_isnonalpha(string_view_t view)
+{
+    return view.chars == NULL
+           || string_charset_scan(string_charset_class(STRING_CLASS_ALPHA), view.chars, view.length, 0) == view.length;
+}